@@ -0,0 +1,51 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "../Dionysus/book_builder.h"
+
+//book_builder <book.bin> <games.pgn>... [ply <n>] [min <n>] [threads <n>] [hash <megabytes>]
+//every pgn file is read in turn into the same book, which is written once they have all been read
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cout << "usage: book_builder <book.bin> <games.pgn>... [ply <n>] [min <n>] [threads <n>] [hash <megabytes>]" << std::endl;
+		return 1;
+	}
+
+	BookBuilderOptions options;
+	std::vector<std::string> pgn_files;
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 < argc && arg == "ply") options.max_ply = std::stoi(argv[++i]);
+		else if (i + 1 < argc && arg == "min") options.min_games = std::stoi(argv[++i]);
+		else if (i + 1 < argc && arg == "threads") options.threads = std::stoi(argv[++i]);
+		else if (i + 1 < argc && arg == "hash") options.hash_megabytes = std::stoi(argv[++i]);
+		else pgn_files.push_back(arg);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	BookBuilder builder(options);
+
+	for (const std::string& path : pgn_files) {
+		std::ifstream file(path);
+		if (!file) {
+			std::cout << "Cant open file " << path << std::endl;
+			return 1;
+		}
+		builder.add_games(file);
+		std::cout << path << ": " << builder.get_games_read() << " games read so far" << std::endl;
+	}
+
+	size_t entries = builder.get_entries();
+	if (!builder.write(argv[1])) {
+		std::cout << "Cant write file " << argv[1] << std::endl;
+		return 1;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << builder.get_games_read() << " games (" << builder.get_games_skipped() << " without a result skipped), "
+		<< entries << " moves counted, written to " << argv[1] << " in " << seconds << "s" << std::endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#define DEFAULT_BENCH_DEPTH 7
+
+//the table size the bench always uses, as a different size would search a different number of nodes
+#define BENCH_HASH_MEGABYTES 16
+
+//searches each of a fixed set of positions to depth on one thread, with no book and an empty table for each, printing the total nodes, time and speed
+//the search is deterministic, so the node count only changes when the search itself does, telling functional changes apart from speed changes
+unsigned long long bench(int depth = DEFAULT_BENCH_DEPTH);
\ No newline at end of file
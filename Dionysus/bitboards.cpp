@@ -0,0 +1,182 @@
+#include "bitboards.h"
+#include "defs.h"
+
+namespace bitboards {
+
+	Bitboard knight_attacks[64];
+	Bitboard king_attacks[64];
+	Bitboard pawn_attacks[2][64];
+	Bitboard rays[8][64];
+	Bitboard between_bb[64][64];
+	Bitboard line_bb[64][64];
+
+	Magic bishop_magics[64];
+	Magic rook_magics[64];
+
+	//every square's attack sets packed back to back, 2^(relevant blocker squares) entries per square
+	Bitboard bishop_table[0x1480];
+	Bitboard rook_table[0x19000];
+
+	//row and column step for each ray direction, matching the order described in bitboards.h
+	const int ray_directions[8][2] = { {0, 1}, {1, -1}, {1, 0}, {1, 1},
+									   {0, -1}, {-1, 1}, {-1, 0}, {-1, -1} };
+
+	const int knight_directions[8][2] = { {1, 2}, {2, 1}, {-1, 2}, {2, -1},
+										  {1, -2}, {-2, 1}, {-1, -2}, {-2, -1} };
+
+	bool on_board(int r, int c) {
+		return r >= 0 && r < 8 && c >= 0 && c < 8;
+	}
+
+	//attacks along a single ray, stopping at (and including) the first occupied square
+	Bitboard ray_attacks(int dir, int square, Bitboard occupied) {
+		Bitboard attacks = rays[dir][square];
+		Bitboard blockers = attacks & occupied;
+		if (blockers) {
+			int blocker = dir < 4 ? lsb(blockers) : msb(blockers);
+			attacks ^= rays[dir][blocker];
+		}
+		return attacks;
+	}
+
+	//slow, ray by ray attacks, only used to fill in the lookup tables
+	//bishops use the odd directions and rooks the even ones
+	Bitboard sliding_attacks(bool bishop, int square, Bitboard occupied) {
+		Bitboard attacks = 0;
+		for (int dir = bishop ? 1 : 0; dir < 8; dir += 2) {
+			attacks |= ray_attacks(dir, square, occupied);
+		}
+		return attacks;
+	}
+
+	//xorshift generator, seeded per row so the same magics are found quickly on every run
+	Bitboard random_bitboard(Bitboard& state) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ULL;
+	}
+
+	//fill in the magic and attack table for one slider on every square
+	//the attack sets for a square are stored from table onwards, and the next square's follow straight after
+	const Bitboard seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+	void init_magics(bool bishop, Magic magics[64], Bitboard* table) {
+		Bitboard occupancies[4096], references[4096];
+		int epoch[4096] = { 0 };
+		int attempt = 0;
+
+		for (int square = 0; square < 64; square++) {
+			Magic& m = magics[square];
+
+			//squares at the end of each ray never change the attacks, so leave them out of the mask
+			m.mask = 0;
+			for (int dir = bishop ? 1 : 0; dir < 8; dir += 2) {
+				Bitboard ray = rays[dir][square];
+				if (ray) m.mask |= ray & ~square_bb(dir < 4 ? msb(ray) : lsb(ray));
+			}
+			m.shift = 64 - popcount(m.mask);
+			m.attacks = table;
+
+			//enumerate every subset of the mask (carry-rippler) with its real attack set
+			int size = 0;
+			Bitboard b = 0;
+			do {
+				occupancies[size] = b;
+				references[size] = sliding_attacks(bishop, square, b);
+				size++;
+				b = (b - m.mask) & m.mask;
+			} while (b);
+
+			table += size;
+
+#ifdef USE_PEXT
+			m.magic = 0;
+			for (int i = 0; i < size; i++) {
+				m.attacks[m.index(occupancies[i])] = references[i];
+			}
+#else
+			//try sparse random numbers until one maps every subset without a destructive collision
+			//epoch marks which entries have been written during the current attempt, so the table never needs clearing
+			Bitboard state = seeds[square / 8];
+			for (int i = 0; i < size; ) {
+				do {
+					m.magic = random_bitboard(state) & random_bitboard(state) & random_bitboard(state);
+				} while (popcount((m.mask * m.magic) >> 56) < 6);
+
+				attempt++;
+				for (i = 0; i < size; i++) {
+					unsigned int index = m.index(occupancies[i]);
+					if (epoch[index] < attempt) {
+						epoch[index] = attempt;
+						m.attacks[index] = references[i];
+					}
+					else if (m.attacks[index] != references[i]) {
+						break;
+					}
+				}
+			}
+#endif
+		}
+	}
+
+	bool init_tables() {
+		for (int r = 0; r < 8; r++) {
+			for (int c = 0; c < 8; c++) {
+				int square = r * 8 + c;
+
+				knight_attacks[square] = 0;
+				for (int i = 0; i < 8; i++) {
+					if (on_board(r + knight_directions[i][0], c + knight_directions[i][1])) {
+						knight_attacks[square] |= square_bb((r + knight_directions[i][0]) * 8 + c + knight_directions[i][1]);
+					}
+				}
+
+				//the king steps one square along each ray
+				king_attacks[square] = 0;
+				for (int i = 0; i < 8; i++) {
+					if (on_board(r + ray_directions[i][0], c + ray_directions[i][1])) {
+						king_attacks[square] |= square_bb((r + ray_directions[i][0]) * 8 + c + ray_directions[i][1]);
+					}
+				}
+
+				//white pawns attack towards row 0, black pawns towards row 7
+				pawn_attacks[WHITE][square] = 0;
+				pawn_attacks[BLACK][square] = 0;
+				for (int dc = -1; dc <= 1; dc += 2) {
+					if (on_board(r - 1, c + dc)) pawn_attacks[WHITE][square] |= square_bb((r - 1) * 8 + c + dc);
+					if (on_board(r + 1, c + dc)) pawn_attacks[BLACK][square] |= square_bb((r + 1) * 8 + c + dc);
+				}
+
+				for (int i = 0; i < 8; i++) {
+					rays[i][square] = 0;
+					for (int j = 1; on_board(r + ray_directions[i][0] * j, c + ray_directions[i][1] * j); j++) {
+						rays[i][square] |= square_bb((r + ray_directions[i][0] * j) * 8 + c + ray_directions[i][1] * j);
+					}
+				}
+			}
+		}
+
+		//the opposite of direction dir is dir ^ 4
+		for (int square = 0; square < 64; square++) {
+			for (int dir = 0; dir < 8; dir++) {
+				Bitboard ray = rays[dir][square];
+				while (ray) {
+					int other = pop_lsb(ray);
+					between_bb[square][other] = rays[dir][square] & ~rays[dir][other] & ~square_bb(other);
+					line_bb[square][other] = rays[dir][square] | rays[dir ^ 4][square] | square_bb(square);
+				}
+			}
+		}
+
+		init_magics(true, bishop_magics, bishop_table);
+		init_magics(false, rook_magics, rook_table);
+		return true;
+	}
+
+	void init() {
+		//function local statics are initialised exactly once, even if several threads get here together
+		static bool initialised = init_tables();
+		(void)initialised;
+	}
+}
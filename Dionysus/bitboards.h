@@ -0,0 +1,116 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//use the BMI2 pext instruction to index the slider attack tables when the compiler is targeting it
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define USE_PEXT
+#endif
+
+//one bit per square, using the same indexing as the board (0 = a8, 63 = h1)
+typedef unsigned long long Bitboard;
+
+const Bitboard FILE_A = 0x0101010101010101ULL;
+const Bitboard FILE_H = FILE_A << 7;
+
+//row 0 is the 8th rank, row 7 is the 1st rank
+inline Bitboard row_bb(int row) {
+	return 0xFFULL << (row * 8);
+}
+
+inline Bitboard square_bb(int square) {
+	return 1ULL << square;
+}
+
+//index of the least significant set bit, b must be non-zero
+inline int lsb(Bitboard b) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, b);
+	return (int)index;
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+//index of the most significant set bit, b must be non-zero
+inline int msb(Bitboard b) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, b);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(b);
+#endif
+}
+
+//removes the least significant set bit from b and returns its index
+inline int pop_lsb(Bitboard& b) {
+	int index = lsb(b);
+	b &= b - 1;
+	return index;
+}
+
+inline int popcount(Bitboard b) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(b);
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+//everything needed to look up a slider's attacks from a single table probe
+//the relevant blockers (occupancy & mask) are mapped to a unique index into attacks, either by pext or by a magic multiply
+struct Magic {
+	Bitboard mask;
+	Bitboard magic;
+	Bitboard* attacks;
+	int shift;
+
+	unsigned int index(Bitboard occupied) const {
+#ifdef USE_PEXT
+		return (unsigned int)_pext_u64(occupied, mask);
+#else
+		return (unsigned int)(((occupied & mask) * magic) >> shift);
+#endif
+	}
+};
+
+namespace bitboards {
+
+	//attack sets for the non-sliding pieces, indexed by the square the piece is on
+	extern Bitboard knight_attacks[64];
+	extern Bitboard king_attacks[64];
+	extern Bitboard pawn_attacks[2][64]; //pawn_attacks[player][square]
+
+	//rays[dir][square] = every square from square (exclusive) to the edge of the board in direction dir
+	//directions 0-3 increase the square index, 4-7 decrease it
+	extern Bitboard rays[8][64];
+
+	//squares strictly between two squares, and the whole line through them, or empty if they do not share a line
+	extern Bitboard between_bb[64][64];
+	extern Bitboard line_bb[64][64];
+
+	extern Magic bishop_magics[64];
+	extern Magic rook_magics[64];
+
+	//fills in the tables above, safe to call more than once
+	void init();
+
+	inline Bitboard bishop_attacks(int square, Bitboard occupied) {
+		const Magic& m = bishop_magics[square];
+		return m.attacks[m.index(occupied)];
+	}
+
+	inline Bitboard rook_attacks(int square, Bitboard occupied) {
+		const Magic& m = rook_magics[square];
+		return m.attacks[m.index(occupied)];
+	}
+
+	inline Bitboard queen_attacks(int square, Bitboard occupied) {
+		return bishop_attacks(square, occupied) | rook_attacks(square, occupied);
+	}
+}
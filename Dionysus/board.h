@@ -4,44 +4,88 @@
 #include <string>
 
 #include "defs.h"
+#include "bitboards.h"
 #include "move.h"
+#include "move_list.h"
 #include "search_result.h"
 
 #include "transposition_table.h"
 
+//longest game (in plies, including the search on top of it) which the state history has room for up front
+#define MAX_GAME_LENGTH 1024
+
+//everything about a position which cannot be worked out again when a move is undone
+//kept as plain data so that pushing a new ply is a single copy into memory which is already allocated
+struct StateInfo {
+	int castling_rights; //bit CASTLING_RIGHT(player, dir) is set if player can still castle in direction dir
+	int en_passant_target;
+	int half_move_clock;
+	unsigned long long zobrist_hash;
+	int king_positions[2];
+
+	//evaluation terms, updated by put_piece and remove_piece
+	int material[2];
+	int psqt_middlegame[2];
+	int psqt_endgame[2];
+};
+
 class Board {
 
 private:
-	std::vector<int> squares;
+	//mailbox, for looking up what is on a given square
+	int squares[64];
+
+	//bitboards, for generating moves and evaluating the position
+	Bitboard pieces[2][6]; // pieces[player][type]
+	Bitboard colours[2];
+	Bitboard occupied;
 
 	bool white_to_move;
 	bool searching;
 
-	//these are stacks so we can easily restore previous board states after trialling board states during minimax
-	std::vector<std::vector<std::vector<bool>>> can_castle; // e.g. can_castle[last_element][player][dir] = can player castle in direction dir. right(1) is kingside
-	std::vector<int> half_move_clock;
-	std::vector<int> en_passant_target;
-	std::vector<std::vector<int>> king_positions;
-	std::vector<std::vector<std::vector<int>>> piece_counts;
-	std::vector<unsigned long long> zobrist_hash;
+	//a stack of states so we can easily restore previous board states after trialling board states during minimax
+	//history[ply] is the current state, earlier entries are the states before each move made since the fen
+	std::vector<StateInfo> history;
+	int ply;
+
+	StateInfo& state() { return history[ply]; }
+	const StateInfo& state() const { return history[ply]; }
+
+	void push_state();
 
 	void init_from_fen(std::string);
 
 	void generate_zobrist_keys();
+
+	void put_piece(int, int, int);
+	void remove_piece(int);
+
+	//restrictions on the squares pieces can move to, so that only legal moves are generated
+	//for pseudo-legal generation nothing is restricted
+	struct MoveMasks {
+		int king;			 //square of the moving side's king, or EMPTY_SQUARE if the king is not checked for safety
+		Bitboard check_mask; //squares which capture or block the checking piece, or every square if not in check
+		Bitboard pinned;	 //pieces which are pinned to the king, and so can only move along the line of the pin
+		bool in_check;
+	};
+
+	MoveMasks get_pseudo_legal_masks();
+	MoveMasks get_legal_masks(int);
+	Bitboard legal_targets(int, const MoveMasks&);
+
+	void add_moves(MoveList&, int, int, int, Bitboard);
 	
-	std::vector<Move> get_pawn_moves(int, int, int);
-	std::vector<Move> get_knight_moves(int, int, int);
-	std::vector<Move> get_bishop_moves(int, int, int);
-	std::vector<Move> get_rook_moves(int, int, int);
-	std::vector<Move> get_queen_moves(int, int, int);
-	std::vector<Move> get_king_moves(int, int, int);
-
-	std::vector<Move> get_pawn_captures(int, int, int);
-	std::vector<Move> get_knight_captures(int, int, int);
-	std::vector<Move> get_bishop_captures(int, int, int);
-	std::vector<Move> get_rook_captures(int, int, int);
-	std::vector<Move> get_queen_captures(int, int, int);
-	std::vector<Move> get_king_captures(int, int, int);
+	void get_pawn_moves(int, MoveList&, const MoveMasks&);
+	void get_pawn_captures(int, MoveList&, const MoveMasks&);
+	void get_knight_moves(int, Bitboard, MoveList&, const MoveMasks&);
+	void get_bishop_moves(int, Bitboard, MoveList&, const MoveMasks&);
+	void get_rook_moves(int, Bitboard, MoveList&, const MoveMasks&);
+	void get_queen_moves(int, Bitboard, MoveList&, const MoveMasks&);
+	void get_king_moves(int, Bitboard, MoveList&, const MoveMasks&);
+	void get_castling_moves(int, MoveList&, const MoveMasks&);
+
+	void generate_captures(int, MoveList&, const MoveMasks&);
+	void generate_quiets(int, MoveList&, const MoveMasks&);
 
 public:
 	Board();
@@ -49,26 +93,38 @@ public:
 	~Board();
 
 	bool make_move(Move);
+	void make_legal_move(Move);
 	void undo_move(Move);
+	Move unpack_move(PackedMove);
 
 	bool in_check(int);
 	bool is_threatened(int, int);
-	bool is_threatened(int, int, std::vector<Move>);
+	Bitboard attackers_to(int, Bitboard);
+
+	bool is_legal(const Move&);
+	int see(const Move&);
 
 	std::vector<int> get_squares();
 	int get_square(int ind);
 	bool is_white_to_move();
-	std::vector<std::vector<bool>> get_castling_rights();
+	int get_castling_rights();
+	bool has_castling_right(int, int);
 	int get_half_move_clock();
 	int get_en_passant_target();
+
+	//built from the polyglot random keys, with the en passant square only counted when a pawn can take onto it
+	//so this is also exactly the key a polyglot book stores the position under
 	unsigned long long get_zobrist_hash();
 
 	bool is_three_move_rep();
 
-	double evaluate_position();
+	int evaluate_position();
 
-	std::vector<Move> get_valid_moves(int);
-	std::vector<Move> get_valid_captures(int);
+	MoveList get_valid_moves(int);
+	MoveList get_valid_captures(int);
+	MoveList get_legal_moves(int);
+	MoveList get_legal_captures(int);
+	MoveList get_legal_quiets(int);
 	void print_board();
 
 };
\ No newline at end of file
@@ -1,18 +1,22 @@
 #include "board.h"
 #include "zobrist_keys.h"
+#include "piece_square_tables.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <map>
 
 Board::Board() {
+	bitboards::init();
 	generate_zobrist_keys();
 	//starting position
 	init_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
 }
 
 Board::Board(std::string fen) {
+	bitboards::init();
 	generate_zobrist_keys();
 	init_from_fen(fen);
 }
@@ -20,19 +24,23 @@ Board::Board(std::string fen) {
 Board::~Board() { }
 
 void Board::init_from_fen(std::string fen) {
-	squares.clear();
-	can_castle.clear();
-	half_move_clock.clear();
-	en_passant_target.clear();
-
-	king_positions.clear();
-	king_positions.push_back({ -1, -1 });
+	for (int i = 0; i < 64; i++) squares[i] = EMPTY_SQUARE;
+	for (int i = 0; i < 6; i++) {
+		pieces[WHITE][i] = 0;
+		pieces[BLACK][i] = 0;
+	}
+	colours[WHITE] = 0;
+	colours[BLACK] = 0;
+	occupied = 0;
 
-	piece_counts.clear();
-	piece_counts.push_back({ {0,0,0,0,0,0}, {0,0,0,0,0,0} });
+	//allocate the whole history once, so making moves never has to
+	history.assign(MAX_GAME_LENGTH, StateInfo());
+	ply = 0;
 
-	zobrist_hash.clear();
-	zobrist_hash.push_back(0);
+	StateInfo& st = state();
+	st.king_positions[WHITE] = -1;
+	st.king_positions[BLACK] = -1;
+	st.zobrist_hash = 0;
 
 	//PLACEMENT OF PIECES
 	int pos = 0;
@@ -45,21 +53,16 @@ void Board::init_from_fen(std::string fen) {
 
 		//if series of empty spaces
 		if (c > '0' && c < '9') {
-			int empty_squares = c - '0';
-			for (int i = 0; i < empty_squares; i++) {
-				squares.push_back(EMPTY_SQUARE);
-				index++;
-			}
+			index += c - '0';
 		} //if an actual piece (but ignore all /s)
 		else if (c != '/') {
-			squares.push_back((c > 96 ? BLACK : WHITE) * 6 + piece_letters[std::tolower(c)]);
-			piece_counts[0][c > 96 ? BLACK : WHITE][piece_letters[std::tolower(c)]]++;
-			zobrist_hash[0] ^= zobrist_keys::piece_locations[index][c > 96 ? BLACK : WHITE][piece_letters[std::tolower(c)]];
+			put_piece(index, c > 96 ? BLACK : WHITE, piece_letters[std::tolower(c)]);
+			st.zobrist_hash ^= zobrist_keys::piece_locations[index][c > 96 ? BLACK : WHITE][piece_letters[std::tolower(c)]];
 			if (c == 'k') {
-				king_positions[0][BLACK] = index;
+				st.king_positions[BLACK] = index;
 			}
 			else if (c == 'K') {
-				king_positions[0][WHITE] = index;
+				st.king_positions[WHITE] = index;
 			}
 			index++;
 		}
@@ -68,30 +71,30 @@ void Board::init_from_fen(std::string fen) {
 	//ACTIVE COLOUR
 	pos = piece_placement.size() + 1;
 	white_to_move = fen[pos] == 'w';
-	if (white_to_move) zobrist_hash[0] ^= zobrist_keys::white_to_move;
+	if (white_to_move) st.zobrist_hash ^= zobrist_keys::white_to_move;
 
 	//CASTLING AVAILABILITY
 	pos += 2;
 	std::string castling_availability = fen.substr(pos, fen.find(' ', pos) - pos);
 
-	can_castle.push_back({ {false, false}, {false, false} });
+	st.castling_rights = 0;
 	for (char c : castling_availability) {
 		switch (c) {
 		case 'K':
-			can_castle[0][WHITE][RIGHT] = true;
-			zobrist_hash[0] ^= zobrist_keys::can_castle[WHITE][RIGHT];
+			st.castling_rights |= CASTLING_RIGHT(WHITE, RIGHT);
+			st.zobrist_hash ^= zobrist_keys::can_castle[WHITE][RIGHT];
 			break;
 		case 'k':
-			can_castle[0][BLACK][RIGHT] = true;
-			zobrist_hash[0] ^= zobrist_keys::can_castle[BLACK][RIGHT];
+			st.castling_rights |= CASTLING_RIGHT(BLACK, RIGHT);
+			st.zobrist_hash ^= zobrist_keys::can_castle[BLACK][RIGHT];
 			break;
 		case 'Q':
-			can_castle[0][WHITE][LEFT] = true;
-			zobrist_hash[0] ^= zobrist_keys::can_castle[WHITE][LEFT];
+			st.castling_rights |= CASTLING_RIGHT(WHITE, LEFT);
+			st.zobrist_hash ^= zobrist_keys::can_castle[WHITE][LEFT];
 			break;
 		case 'q':
-			can_castle[0][BLACK][LEFT] = true;
-			zobrist_hash[0] ^= zobrist_keys::can_castle[BLACK][LEFT];
+			st.castling_rights |= CASTLING_RIGHT(BLACK, LEFT);
+			st.zobrist_hash ^= zobrist_keys::can_castle[BLACK][LEFT];
 			break;
 		}
 	}
@@ -101,20 +104,19 @@ void Board::init_from_fen(std::string fen) {
 	std::string ep_target = fen.substr(pos, fen.find(' ', pos) - pos);
 
 	if (ep_target[0] == '-') {
-		en_passant_target = { EMPTY_SQUARE };
+		st.en_passant_target = EMPTY_SQUARE;
 	}
 	else {
 		int target = get_square_index_from_notation(ep_target);
 		int pawn_square = target + (white_to_move ? 8 : -8);
-		std::cout << target << std::endl;
 		int opp = white_to_move ? WHITE : BLACK;
 		//if there is actually an enemy pawn threatening us
 		if ((pawn_square % 8 < 7 && squares[pawn_square + 1] == (opp * 6 + PAWN)) || (pawn_square % 8 > 0 && squares[pawn_square - 1] == (opp * 6 + PAWN))) {
-			en_passant_target = { target };
-			zobrist_hash[0] ^= zobrist_keys::en_passant_target[ep_target[0] - 'a'];
+			st.en_passant_target = target;
+			st.zobrist_hash ^= zobrist_keys::en_passant_target[ep_target[0] - 'a'];
 		}
 		else {
-			en_passant_target = { EMPTY_SQUARE };
+			st.en_passant_target = EMPTY_SQUARE;
 		}
 		
 	}
@@ -123,7 +125,7 @@ void Board::init_from_fen(std::string fen) {
 	pos += ep_target.size() + 1;
 	std::string hm_clock = fen.substr(pos, fen.find(' ', pos) - pos);
 
-	half_move_clock = { std::stoi(hm_clock) };
+	st.half_move_clock = std::stoi(hm_clock);
 
 	//FULLMOVE NUMBER
 	//Not currently being used
@@ -131,224 +133,326 @@ void Board::init_from_fen(std::string fen) {
 
 //set the zobrist key for each possible board feature
 //to create zobrist hash, all applicable keys are XORed together
+//the keys are shared by every board, so they are only filled in by the first one, however many threads are making boards
 void Board::generate_zobrist_keys() {
+	static bool generated = [] {
+		//side to move key
+		zobrist_keys::white_to_move = zobrist_keys::keys[780];
 
-	//side to move key
-	zobrist_keys::white_to_move = zobrist_keys::keys[780];
-
-	//castling rights keys
-	zobrist_keys::can_castle = { {0,0}, {0,0} };
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			zobrist_keys::can_castle[i][j] = zobrist_keys::keys[768 + i * 2 + (1 - j)];
+		//castling rights keys
+		zobrist_keys::can_castle = { {0,0}, {0,0} };
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < 2; j++) {
+				zobrist_keys::can_castle[i][j] = zobrist_keys::keys[768 + i * 2 + (1 - j)];
+			}
 		}
-	}
 
-	//en_passant_target keys
-	for (int i = 0; i < 8; i++) {
-		zobrist_keys::en_passant_target.push_back(zobrist_keys::keys[772+i]);
-	}
+		//en_passant_target keys
+		zobrist_keys::en_passant_target.assign(8, 0);
+		for (int i = 0; i < 8; i++) {
+			zobrist_keys::en_passant_target[i] = zobrist_keys::keys[772 + i];
+		}
 
-	//piece locations keys
-	for (int r = 0; r < 8; r++) {
-		for (int c = 0; c < 8; c++) {
-			zobrist_keys::piece_locations.push_back({ {0,0,0,0,0,0}, {0,0,0,0,0,0} });
-			for (int j = 0; j < 2; j++) {
-				for (int k = 0; k < 6; k++) {
-					zobrist_keys::piece_locations[r * 8 + c][j][k] = zobrist_keys::keys[(7 - r) * 8 + c + 64 * (k*2+(1-j))];
+		//piece locations keys
+		zobrist_keys::piece_locations.assign(64, { {0,0,0,0,0,0}, {0,0,0,0,0,0} });
+		for (int r = 0; r < 8; r++) {
+			for (int c = 0; c < 8; c++) {
+				for (int j = 0; j < 2; j++) {
+					for (int k = 0; k < 6; k++) {
+						zobrist_keys::piece_locations[r * 8 + c][j][k] = zobrist_keys::keys[(7 - r) * 8 + c + 64 * (k*2+(1-j))];
+					}
 				}
 			}
 		}
-	}
+		return true;
+	}();
+	(void)generated;
+}
+
+//place a piece on an empty square, keeping the mailbox, bitboards and evaluation in sync
+void Board::put_piece(int square, int player, int type) {
+	squares[square] = player * 6 + type;
+	pieces[player][type] |= square_bb(square);
+	colours[player] |= square_bb(square);
+	occupied |= square_bb(square);
+
+	//black pieces use the tables mirrored vertically, which is square ^ 56
+	int table_square = player == WHITE ? square : square ^ 56;
+	StateInfo& st = state();
+	st.material[player] += piece_square_tables::piece_values[type];
+	st.psqt_middlegame[player] += piece_square_tables::middlegame[type][table_square];
+	st.psqt_endgame[player] += piece_square_tables::endgame[type][table_square];
+}
+
+//remove whatever piece is on an occupied square
+void Board::remove_piece(int square) {
+	int code = squares[square];
+	int player = code / 6;
+	int type = code % 6;
+	squares[square] = EMPTY_SQUARE;
+	pieces[player][type] &= ~square_bb(square);
+	colours[player] &= ~square_bb(square);
+	occupied &= ~square_bb(square);
+
+	int table_square = player == WHITE ? square : square ^ 56;
+	StateInfo& st = state();
+	st.material[player] -= piece_square_tables::piece_values[type];
+	st.psqt_middlegame[player] -= piece_square_tables::middlegame[type][table_square];
+	st.psqt_endgame[player] -= piece_square_tables::endgame[type][table_square];
 }
 
 //assumes that the move is pseudo-legal
+//if the move would leave the player's king in check, it is not made and false is returned
 bool Board::make_move(Move m) {
-	can_castle.push_back(can_castle.back());
-	king_positions.push_back(king_positions.back());
-	piece_counts.push_back(piece_counts.back());
-	zobrist_hash.push_back(zobrist_hash.back());
-	
-	//if rook killed, need to disallow castling on that side
-	if (m.prev_square % 6 == ROOK) {
-		//if rook killed on left
-		if (m.end % 8 == 0) {
-			can_castle.back()[m.player == WHITE ? BLACK : WHITE][LEFT] = false;
-			zobrist_hash.back() ^= zobrist_keys::can_castle[m.player == WHITE ? BLACK : WHITE][LEFT];
-		} //if rook killed in right
-		else if (m.end % 8 == 7) {
-			can_castle.back()[m.player == WHITE ? BLACK : WHITE][RIGHT] = false;
-			zobrist_hash.back() ^= zobrist_keys::can_castle[m.player == WHITE ? BLACK : WHITE][RIGHT];
-		}
+
+	//cannot castle out of or through check (castling into check is caught by in_check below)
+	if (m.start_type == KING && abs(m.start - m.end) == 2) {
+		if (is_threatened(m.player, m.start) || is_threatened(m.player, (m.start + m.end) / 2)) return false;
 	}
 
-	//if move rook, may need to disallow castling on a side
-	if (m.start_type == ROOK) {
-		//if rook started on left
-		if (m.start % 8 == 0) {
-			can_castle.back()[m.player][LEFT] = false;
-			zobrist_hash.back() ^= zobrist_keys::can_castle[m.player][LEFT];
-		} //if rook started in right
-		else if (m.start % 8 == 7) {
-			can_castle.back()[m.player][RIGHT] = false;
-			zobrist_hash.back() ^= zobrist_keys::can_castle[m.player][RIGHT];
-		}
-	}//if king moved, update king pos and remove castle rights
-	else if (m.start_type == KING) {
-		can_castle.back()[m.player][LEFT] = false;
-		can_castle.back()[m.player][RIGHT] = false;
+	make_legal_move(m);
+
+	//if king is in check, undo move and return false
+	if (in_check(m.player)) {
+		undo_move(m);
+		return false;
+	}
 
-		zobrist_hash.back() ^= zobrist_keys::can_castle[m.player][LEFT];
-		zobrist_hash.back() ^= zobrist_keys::can_castle[m.player][RIGHT];
+	//king is not in check, move is legal
+	return true;
+}
+
+//the castling rights which are lost when a piece moves from or to each square
+//moving the king loses both of its player's rights, and moving or capturing a rook loses the right on its side
+const int castling_rights_lost[64] = {
+	CASTLING_RIGHT(BLACK, LEFT), 0, 0, 0, CASTLING_RIGHT(BLACK, LEFT) | CASTLING_RIGHT(BLACK, RIGHT), 0, 0, CASTLING_RIGHT(BLACK, RIGHT),
+	0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0,
+	CASTLING_RIGHT(WHITE, LEFT), 0, 0, 0, CASTLING_RIGHT(WHITE, LEFT) | CASTLING_RIGHT(WHITE, RIGHT), 0, 0, CASTLING_RIGHT(WHITE, RIGHT) };
+
+//copy the current state up one ply, ready for a move to change it
+void Board::push_state() {
+	//only grows if a game outlasts MAX_GAME_LENGTH, which in practice never happens
+	if (ply + 1 == (int)history.size()) history.resize(history.size() * 2);
+	history[ply + 1] = history[ply];
+	ply++;
+}
 
-		//update king_positions
-		king_positions.back()[m.player] = m.end;
+//assumes that the move is fully legal, e.g. one from get_legal_moves, so skips checking the king's safety
+void Board::make_legal_move(Move m) {
+	push_state();
+	StateInfo& st = state();
+
+	int opp = m.player == WHITE ? BLACK : WHITE;
+
+	//moving from or onto a king or rook's starting square may lose castling rights
+	//only the rights which actually change are toggled in the hash
+	int lost = st.castling_rights & (castling_rights_lost[m.start] | castling_rights_lost[m.end]);
+	if (lost) {
+		st.castling_rights ^= lost;
+		for (int i = 0; i < 4; i++) {
+			if (lost & (1 << i)) st.zobrist_hash ^= zobrist_keys::can_castle[i / 2][i % 2];
+		}
+	}
+
+	//if king moved, update king pos
+	if (m.start_type == KING) {
+		st.king_positions[m.player] = m.end;
 	}
 
 	//increment the half_move_clock
-	half_move_clock.push_back(half_move_clock.back());
-	half_move_clock.back()++;
+	st.half_move_clock++;
 	//if pawn move or capture made, reset half_move_clock
 	if (m.start_type == PAWN || m.prev_square != EMPTY_SQUARE) {
-		half_move_clock.back() = 0;
+		st.half_move_clock = 0;
 	}
 
 	//update en_passant_target
-	if (en_passant_target.back() != EMPTY_SQUARE) {
-		zobrist_hash.back() ^= zobrist_keys::en_passant_target[en_passant_target.back() % 8];
+	if (st.en_passant_target != EMPTY_SQUARE) {
+		st.zobrist_hash ^= zobrist_keys::en_passant_target[st.en_passant_target % 8];
 	}
-	en_passant_target.push_back(EMPTY_SQUARE);
+	st.en_passant_target = EMPTY_SQUARE;
 	if (m.start_type == PAWN && abs(m.start - m.end) == 16) {
-		int opp = m.player == WHITE ? BLACK : WHITE;
 		//if there is actually an enemy pawn threatening us
-		if ((m.end % 8 < 7 && squares[m.end + 1] == (opp * 6 + PAWN)) || (m.end % 8 > 0 && squares[m.end - 1] == (opp * 6 + PAWN))) {
-			en_passant_target.back() = (m.start + m.end) / 2;
-			zobrist_hash.back() ^= zobrist_keys::en_passant_target[m.start % 8];
+		if (bitboards::pawn_attacks[m.player][(m.start + m.end) / 2] & pieces[opp][PAWN]) {
+			st.en_passant_target = (m.start + m.end) / 2;
+			st.zobrist_hash ^= zobrist_keys::en_passant_target[m.start % 8];
 		}
 	}
 
 	//if en passant
 	if (m.start_type == PAWN && m.prev_square == EMPTY_SQUARE && abs(m.start - m.end) % 8 != 0) {
-		if (m.player == WHITE) {
-			zobrist_hash.back() ^= zobrist_keys::piece_locations[m.end + 8][BLACK][PAWN];
-			squares[m.end + 8] = EMPTY_SQUARE;
-		}
-		else {
-			zobrist_hash.back() ^= zobrist_keys::piece_locations[m.end - 8][WHITE][PAWN];
-			squares[m.end - 8] = EMPTY_SQUARE;
-		}
-		piece_counts.back()[m.player == WHITE ? BLACK : WHITE][PAWN]--;
+		int captured_square = m.player == WHITE ? m.end + 8 : m.end - 8;
+		st.zobrist_hash ^= zobrist_keys::piece_locations[captured_square][opp][PAWN];
+		remove_piece(captured_square);
 	}
 
 	//if castle
-	bool legal_castle = true;
 	if (m.start_type == KING && abs(m.start - m.end) == 2) {
 
-		if (is_threatened(m.player, m.start)) legal_castle = false;
 		bool right = m.end > m.start;
 		int rook_pos = (m.start + m.end) / 2;
 
-		zobrist_hash.back() ^= zobrist_keys::piece_locations[rook_pos][m.player][ROOK];
-		squares[rook_pos] = m.player * 6 + ROOK;
+		st.zobrist_hash ^= zobrist_keys::piece_locations[rook_pos][m.player][ROOK];
+		put_piece(rook_pos, m.player, ROOK);
 
-		if (is_threatened(m.player, rook_pos)) legal_castle = false;
-
-		zobrist_hash.back() ^= zobrist_keys::piece_locations[right ? (m.start + 3) : (m.start - 4)][m.player][ROOK];
-		squares[right ? (m.start + 3) : (m.start - 4)] = EMPTY_SQUARE;
+		st.zobrist_hash ^= zobrist_keys::piece_locations[right ? (m.start + 3) : (m.start - 4)][m.player][ROOK];
+		remove_piece(right ? (m.start + 3) : (m.start - 4));
 	}
 
-	//update piece counts if there is a capture
+	//take off the captured piece, if there is one
 	if (squares[m.end] != EMPTY_SQUARE) {
-		piece_counts.back()[m.player == WHITE ? BLACK : WHITE][squares[m.end] % 6]--;
-		zobrist_hash.back() ^= zobrist_keys::piece_locations[m.end][m.player == WHITE ? BLACK : WHITE][squares[m.end] % 6];
-	}
-
-	//if promoting, need to update piece counts
-	if (m.start_type == PAWN && m.end_type != PAWN) {
-		piece_counts.back()[m.player][PAWN]--;
-		piece_counts.back()[m.player][m.end_type]++;
+		st.zobrist_hash ^= zobrist_keys::piece_locations[m.end][opp][squares[m.end] % 6];
+		remove_piece(m.end);
 	}
 
 	//update the zobrist hash for the board change
-	zobrist_hash.back() ^= zobrist_keys::piece_locations[m.end][m.player][m.end_type];
-	zobrist_hash.back() ^= zobrist_keys::piece_locations[m.start][m.player][m.start_type];
+	st.zobrist_hash ^= zobrist_keys::piece_locations[m.end][m.player][m.end_type];
+	st.zobrist_hash ^= zobrist_keys::piece_locations[m.start][m.player][m.start_type];
 
 	//update the actual board
-	squares[m.end] = m.player * 6 + m.end_type;
-	squares[m.start] = EMPTY_SQUARE;
+	remove_piece(m.start);
+	put_piece(m.end, m.player, m.end_type);
 
 	//flip who is to play
 	white_to_move = !white_to_move;
-	zobrist_hash.back() ^= zobrist_keys::white_to_move;
-
-	//if king is in check, undo move and return false
-	if (in_check(m.player) || !legal_castle) {
-		undo_move(m);
-		return false;
-	}
-
-	//king is not in check, move is legal
-	return true;
+	st.zobrist_hash ^= zobrist_keys::white_to_move;
 }
 
 void Board::undo_move(Move m) {
-	//pop last move off of stacks
-	can_castle.pop_back();
-	half_move_clock.pop_back();
-	en_passant_target.pop_back();
-	king_positions.pop_back();
-	piece_counts.pop_back();
-	zobrist_hash.pop_back();
-
 	//restore board pos
-	squares[m.start] = m.player * 6 + m.start_type;
-	squares[m.end] = m.prev_square;
+	//the state is popped afterwards, so putting the pieces back only changes the evaluation of the state being thrown away
+	remove_piece(m.end);
+	put_piece(m.start, m.player, m.start_type);
+	if (m.prev_square != EMPTY_SQUARE) put_piece(m.end, m.prev_square / 6, m.prev_square % 6);
 
 	//if en passant
 	if (m.start_type == PAWN && m.prev_square == EMPTY_SQUARE && abs(m.start - m.end) % 8 != 0) {
-		if (m.player == WHITE) squares[m.end + 8] = BLACK * 6 + PAWN;
-		else squares[m.end - 8] = WHITE * 6 + PAWN;
+		if (m.player == WHITE) put_piece(m.end + 8, BLACK, PAWN);
+		else put_piece(m.end - 8, WHITE, PAWN);
 	}
 
 	//if castle
 	if (m.start_type == KING && abs(m.start - m.end) == 2) {
 		bool right = m.end > m.start;
-		squares[(m.start + m.end) / 2] = EMPTY_SQUARE;
-		squares[right ? (m.start + 3) : (m.start - 4)] = m.player * 6 + ROOK;
+		remove_piece((m.start + m.end) / 2);
+		put_piece(right ? (m.start + 3) : (m.start - 4), m.player, ROOK);
 	}
 
+	//pop last state off of the stack
+	ply--;
+
 	white_to_move = !white_to_move;
 }
 
+//fill in the rest of a packed move from what is currently on the board
+//the move must start on a square with a piece on it
+Move Board::unpack_move(PackedMove pm) {
+	int start = packed_start(pm);
+	int end = packed_end(pm);
+	int start_type = squares[start] % 6;
+	int end_type = packed_promotion(pm) != PAWN ? packed_promotion(pm) : start_type;
+	return Move(squares[start] / 6, start, end, start_type, end_type, squares[end]);
+}
+
 bool Board::in_check(int player) {
-	return is_threatened(player, king_positions.back()[player]);
+	return is_threatened(player, state().king_positions[player]);
 }
 
+//if the square pos is attacked by any of player's opponent's pieces
+//looks outwards from pos as each type of piece, since a piece on pos attacks exactly the squares which could attack it
 bool Board::is_threatened(int player, int pos) {
-	std::vector<Move> opponent_moves = get_valid_moves(player == WHITE ? BLACK : WHITE);
-	return is_threatened(player, pos, opponent_moves);
+	if (pos == EMPTY_SQUARE) return false;
+	return attackers_to(pos, occupied) & colours[player == WHITE ? BLACK : WHITE];
 }
 
-//if the piece in position pos owned by player is under attack from any of the given moves
-bool Board::is_threatened(int player, int pos, std::vector<Move> moves) {
-	bool pawn = squares[pos] % 6 == PAWN;
-	for (Move m : moves) {
-		if (m.end == pos) return true;
-		if (pawn && m.start_type == PAWN && m.end == en_passant_target.back() && abs(m.end - pos) == 8) return true;
+//every piece of either colour attacking square, given the occupancy (which need not be the current one)
+Bitboard Board::attackers_to(int square, Bitboard occ) {
+	return (bitboards::pawn_attacks[WHITE][square] & pieces[BLACK][PAWN])
+		| (bitboards::pawn_attacks[BLACK][square] & pieces[WHITE][PAWN])
+		| (bitboards::knight_attacks[square] & (pieces[WHITE][KNIGHT] | pieces[BLACK][KNIGHT]))
+		| (bitboards::king_attacks[square] & (pieces[WHITE][KING] | pieces[BLACK][KING]))
+		| (bitboards::bishop_attacks(square, occ) & (pieces[WHITE][BISHOP] | pieces[BLACK][BISHOP] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN]))
+		| (bitboards::rook_attacks(square, occ) & (pieces[WHITE][ROOK] | pieces[BLACK][ROOK] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN]));
+}
+
+//rough piece values for exchanges, the king is worth more than everything else put together
+const int see_values[6] = { 100, 310, 330, 500, 925, 20000 };
+
+//static exchange evaluation: the material m wins (or loses, if negative) once both sides have finished recapturing on its target square
+//each side recaptures with its least valuable piece first, and can stop whenever carrying on would lose material
+int Board::see(const Move& m) {
+	int gain[32];
+	int d = 0;
+
+	Bitboard occ = occupied ^ square_bb(m.start);
+
+	//what the move itself captures, including the pawn taken en passant and any promotion
+	if (m.prev_square != EMPTY_SQUARE) {
+		gain[0] = see_values[m.prev_square % 6];
 	}
-	return false;
+	else if (m.start_type == PAWN && (m.end - m.start) % 8 != 0) {
+		gain[0] = see_values[PAWN];
+		occ ^= square_bb(m.player == WHITE ? m.end + 8 : m.end - 8);
+	}
+	else {
+		gain[0] = 0;
+	}
+	if (m.end_type != m.start_type) gain[0] += see_values[m.end_type] - see_values[PAWN];
+
+	Bitboard diagonal_sliders = pieces[WHITE][BISHOP] | pieces[BLACK][BISHOP] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+	Bitboard straight_sliders = pieces[WHITE][ROOK] | pieces[BLACK][ROOK] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+
+	Bitboard attackers = attackers_to(m.end, occ) & occ;
+	int on_square = m.end_type;
+	int side = m.player == WHITE ? BLACK : WHITE;
+
+	while (true) {
+		Bitboard side_attackers = attackers & colours[side];
+		if (!side_attackers) break;
+
+		int type = PAWN;
+		while (!(side_attackers & pieces[side][type])) type++;
+
+		//the king can only recapture if nothing can take it back
+		if (type == KING && (attackers & colours[side == WHITE ? BLACK : WHITE])) break;
+
+		d++;
+		gain[d] = see_values[on_square] - gain[d - 1];
+
+		//taking the attacker off the board may uncover a slider behind it
+		occ ^= square_bb(lsb(side_attackers & pieces[side][type]));
+		attackers |= (bitboards::bishop_attacks(m.end, occ) & diagonal_sliders) | (bitboards::rook_attacks(m.end, occ) & straight_sliders);
+		attackers &= occ;
+
+		on_square = type;
+		side = side == WHITE ? BLACK : WHITE;
+	}
+
+	//each side can choose to stop recapturing, so work back from the end of the sequence
+	while (d > 0) {
+		gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+		d--;
+	}
+
+	return gain[0];
 }
 
 //has the current position been seen twice before
 bool Board::is_three_move_rep() {
 	//if pawn move or capture in last 6, impossible for three fold rep
-	if (half_move_clock.back() < 4) return false;
+	const StateInfo& st = state();
+	if (st.half_move_clock < 4) return false;
 
-	//iterate backwards and count occurences of current hash, until last irreversible move
+	//iterate backwards and count occurences of current hash, until last irreversible move (or the start of the history)
 	int seen = 1;
-	int ind = zobrist_hash.size() - 2;
-	while (zobrist_hash.size() - ind <= half_move_clock.back()) {
-		if (zobrist_hash[ind] == zobrist_hash.back()) {
+	int ind = ply - 1;
+	while (ind >= 0 && ply - ind <= st.half_move_clock) {
+		if (history[ind].zobrist_hash == st.zobrist_hash) {
 			seen++;
 			if (seen >= 3) return true;
 		} 
@@ -375,7 +479,7 @@ void Board::print_board() {
 }
 
 std::vector<int> Board::get_squares() {
-	return squares;
+	return std::vector<int>(squares, squares + 64);
 }
 
 int Board::get_square(int ind) {
@@ -386,185 +490,39 @@ bool Board::is_white_to_move() {
 	return white_to_move;
 }
 
-std::vector<std::vector<bool>> Board::get_castling_rights() {
-	return can_castle.back();
+//bitmask of CASTLING_RIGHT(player, dir) for every right still held
+int Board::get_castling_rights() {
+	return state().castling_rights;
+}
+
+bool Board::has_castling_right(int player, int dir) {
+	return state().castling_rights & CASTLING_RIGHT(player, dir);
 }
 
 int Board::get_half_move_clock() {
-	return half_move_clock.back();
+	return state().half_move_clock;
 }
 
 int Board::get_en_passant_target() {
-	return en_passant_target.back();
+	return state().en_passant_target;
 }
 
 unsigned long long Board::get_zobrist_hash() {
-	return zobrist_hash.back();
+	return state().zobrist_hash;
 }
 
-std::vector<std::vector<std::vector<double>>> piece_square_tables =
-//pawn
-{ {{0,  0,  0,  0,  0,  0,  0,  0},
-{50, 50, 50, 50, 50, 50, 50, 50},
-{10, 10, 20, 30, 30, 20, 10, 10},
-{5,  5, 10, 25, 25, 10,  5,  5},
-{0,  0,  0, 20, 20,  0,  0,  0},
-{5, -5,-10,  0,  0,-10, -5,  5},
-{5, 10, 10,-20,-20, 10, 10,  5},
-{0,  0,  0,  0,  0,  0,  0,  0}},
-
-//knight
-{{-50,-40,-30,-30,-30,-30,-40,-50},
-{-40,-20,  0,  0,  0,  0,-20,-40},
-{-30,  0, 10, 15, 15, 10,  0,-30},
-{-30,  5, 15, 20, 20, 15,  5,-30},
-{-30,  0, 15, 20, 20, 15,  0,-30},
-{-30,  5, 10, 15, 15, 10,  5,-30},
-{-40,-20,  0,  5,  5,  0,-20,-40},
-{-50,-40,-30,-30,-30,-30,-40,-50}},
-
-//bishop
-{{-20,-10,-10,-10,-10,-10,-10,-20},
-{-10,  0,  0,  0,  0,  0,  0,-10},
-{-10,  0,  5, 10, 10,  5,  0,-10},
-{-10,  5,  5, 10, 10,  5,  5,-10},
-{-10,  0, 10, 10, 10, 10,  0,-10},
-{-10, 10, 10, 10, 10, 10, 10,-10},
-{-10,  5,  0,  0,  0,  0,  5,-10},
-{-20,-10,-10,-10,-10,-10,-10,-20}},
-
-//rook
-{{0,  0,  0,  0,  0,  0,  0,  0},
-{5, 10, 10, 10, 10, 10, 10,  5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{0,  0,  0,  5,  5,  0,  0,  0}},
-
-//queen
-{{-20,-10,-10, -5, -5,-10,-10,-20},
-{-10,  0,  0,  0,  0,  0,  0,-10},
-{-10,  0,  5,  5,  5,  5,  0,-10},
-{-5,  0,  5,  5,  5,  5,  0, -5},
-{0,  0,  5,  5,  5,  5,  0, -5},
-{-10,  5,  5,  5,  5,  5,  0,-10},
-{-10,  0,  5,  0,  0,  0,  0,-10},
-{-20,-10,-10, -5, -5,-10,-10,-20}},
-
-//king
-{{-30,-40,-40,-50,-50,-40,-40,-30},
-{-30,-40,-40,-50,-50,-40,-40,-30},
-{-30,-40,-40,-50,-50,-40,-40,-30},
-{-30,-40,-40,-50,-50,-40,-40,-30},
-{-20,-30,-30,-40,-40,-30,-30,-20},
-{-10,-20,-20,-20,-20,-20,-20,-10},
-{20, 20,  0,  0,  0,  0, 20, 20},
-{20, 30, 10,  0,  0, 10, 30, 20}} };
-
-//only change is king 
-std::vector<std::vector<std::vector<double>>> endgame_piece_square_tables =
-//pawn
-{ {{0,  0,  0,  0,  0,  0,  0,  0},
-{50, 50, 50, 50, 50, 50, 50, 50},
-{10, 10, 20, 30, 30, 20, 10, 10},
-{5,  5, 10, 25, 25, 10,  5,  5},
-{0,  0,  0, 20, 20,  0,  0,  0},
-{5, -5,-10,  0,  0,-10, -5,  5},
-{5, 10, 10,-20,-20, 10, 10,  5},
-{0,  0,  0,  0,  0,  0,  0,  0}},
-
-//knight
-{{-50,-40,-30,-30,-30,-30,-40,-50},
-{-40,-20,  0,  0,  0,  0,-20,-40},
-{-30,  0, 10, 15, 15, 10,  0,-30},
-{-30,  5, 15, 20, 20, 15,  5,-30},
-{-30,  0, 15, 20, 20, 15,  0,-30},
-{-30,  5, 10, 15, 15, 10,  5,-30},
-{-40,-20,  0,  5,  5,  0,-20,-40},
-{-50,-40,-30,-30,-30,-30,-40,-50}},
-
-//bishop
-{{-20,-10,-10,-10,-10,-10,-10,-20},
-{-10,  0,  0,  0,  0,  0,  0,-10},
-{-10,  0,  5, 10, 10,  5,  0,-10},
-{-10,  5,  5, 10, 10,  5,  5,-10},
-{-10,  0, 10, 10, 10, 10,  0,-10},
-{-10, 10, 10, 10, 10, 10, 10,-10},
-{-10,  5,  0,  0,  0,  0,  5,-10},
-{-20,-10,-10,-10,-10,-10,-10,-20}},
-
-//rook
-{{0,  0,  0,  0,  0,  0,  0,  0},
-{5, 10, 10, 10, 10, 10, 10,  5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{-5,  0,  0,  0,  0,  0,  0, -5},
-{0,  0,  0,  5,  5,  0,  0,  0}},
-
-//queen
-{{-20,-10,-10, -5, -5,-10,-10,-20},
-{-10,  0,  0,  0,  0,  0,  0,-10},
-{-10,  0,  5,  5,  5,  5,  0,-10},
-{-5,  0,  5,  5,  5,  5,  0, -5},
-{0,  0,  5,  5,  5,  5,  0, -5},
-{-10,  5,  5,  5,  5,  5,  0,-10},
-{-10,  0,  5,  0,  0,  0,  0,-10},
-{-20,-10,-10, -5, -5,-10,-10,-20}},
-
-//king
-{{-50,-40,-30,-20,-20,-30,-40,-50},
-{-30,-20,-10,  0,  0,-10,-20,-30},
-{-30,-10, 20, 30, 30, 20,-10,-30},
-{-30,-10, 30, 40, 40, 30,-10,-30},
-{-30,-10, 30, 40, 40, 30,-10,-30},
-{-30,-10, 20, 30, 30, 20,-10,-30},
-{-30,-30,  0,  0,  0,  0,-30,-30},
-{-50,-30,-30,-30,-30,-30,-30,-50}} };
-
-//currently only based on piece values and mobility (number of available moves)
-double Board::evaluate_position() {
-
-	double val = 0;
-	double wpiece_count = 0;
-	double bpiece_count = 0;
-
-	//count material for either side
-	wpiece_count += piece_counts.back()[WHITE][PAWN];
-	wpiece_count += piece_counts.back()[WHITE][KNIGHT] * 3.1;
-	wpiece_count += piece_counts.back()[WHITE][BISHOP] * 3.3;
-	wpiece_count += piece_counts.back()[WHITE][ROOK] * 5;
-	wpiece_count += piece_counts.back()[WHITE][QUEEN] * 9.25;
-
-	bpiece_count += piece_counts.back()[BLACK][PAWN];
-	bpiece_count += piece_counts.back()[BLACK][KNIGHT] * 3.1;
-	bpiece_count += piece_counts.back()[BLACK][BISHOP] * 3.3;
-	bpiece_count += piece_counts.back()[BLACK][ROOK] * 5;
-	bpiece_count += piece_counts.back()[BLACK][QUEEN] * 9.25;
-
-	val += wpiece_count - bpiece_count;
+//in centipawns, from white's point of view
+//currently only based on piece values and where each piece is
+//both are kept up to date as pieces are put on and taken off the board, so this is just a few additions
+int Board::evaluate_position() {
+	const StateInfo& st = state();
 
 	//use different piece square table for endgame, as better to bring king into centre then
-	bool endgame = std::min(wpiece_count, bpiece_count) <= 8;
+	bool endgame = std::min(st.material[WHITE], st.material[BLACK]) <= piece_square_tables::endgame_material;
 
-	//piece square table to give better place pieces better weight
-	for (int r = 0; r < 8; r++) {
-		for (int c = 0; c < 8; c++) {
-			if (squares[r * 8 + c] == EMPTY_SQUARE) continue;
-			int code = squares[r * 8 + c];
-			if (code / 6 == WHITE) {
-				if (endgame) val += endgame_piece_square_tables[code % 6][r][c] * 0.01;
-				else val += piece_square_tables[code % 6][r][c] * 0.01;
-			}
-			else {
-				if (endgame) val -= endgame_piece_square_tables[code % 6][7 - r][c] * 0.01;
-				else val -= piece_square_tables[code % 6][7 - r][c] * 0.01;
-			}
-		}
-	}
+	int val = st.material[WHITE] - st.material[BLACK];
+	if (endgame) val += st.psqt_endgame[WHITE] - st.psqt_endgame[BLACK];
+	else val += st.psqt_middlegame[WHITE] - st.psqt_middlegame[BLACK];
 
 	return val;
 }
\ No newline at end of file
@@ -1,464 +1,377 @@
 #include "board.h"
 
-std::vector<Move> Board::get_valid_moves(int player) {
-
-	std::vector<Move> moves = get_valid_captures(player);
-
-	for (int r = 0; r < 8; r++) {
-		for (int c = 0; c < 8; c++) {
-
-			int code = squares[r * 8 + c];
-			if (code == EMPTY_SQUARE || code / 6 != player) continue;
-			int type = code % 6;
-
-			std::vector<Move> tmp;
-
-			switch (type) {
-			case PAWN:
-				tmp = get_pawn_moves(player, r, c);
-				break;
-			case KNIGHT:
-				tmp = get_knight_moves(player, r, c);
-				break;
-			case BISHOP:
-				tmp = get_bishop_moves(player, r, c);
-				break;
-			case ROOK:
-				tmp = get_rook_moves(player, r, c);
-				break;
-			case QUEEN:
-				tmp = get_queen_moves(player, r, c);
-				break;
-			case KING:
-				tmp = get_king_moves(player, r, c);
-				break;
-			}
+//pseudo-legal moves may leave the player's king in check, so each one still has to be tried with make_move
+//generated moves are appended straight onto the list, which the caller gets back without a copy
+MoveList Board::get_valid_moves(int player) {
+	MoveList moves;
+	MoveMasks masks = get_pseudo_legal_masks();
 
-			moves.insert(moves.end(), tmp.begin(), tmp.end());
-		}
-	}
+	generate_captures(player, moves, masks);
+	generate_quiets(player, moves, masks);
 
 	return moves;
 }
 
-std::vector<Move> Board::get_pawn_moves(int player, int r, int c) {
-	std::vector<Move> moves;
+MoveList Board::get_valid_captures(int player) {
+	MoveList moves;
+	MoveMasks masks = get_pseudo_legal_masks();
 
-	int dir = player == WHITE ? -1 : 1;
+	generate_captures(player, moves, masks);
 
-	std::vector<int> promotion_types = { KNIGHT, BISHOP, ROOK, QUEEN };
-
-	int target_code = squares[(r + dir) * 8 + c];
-	if (target_code == EMPTY_SQUARE) {
+	return moves;
+}
 
-		// can promote if reach 8th rank
-		if (r + dir == 0 || r + dir == 7) {
-			for (auto& type : promotion_types) {
-				Move m = { player, r * 8 + c, (r + dir) * 8 + c, PAWN, type, target_code };
-				moves.push_back(m);
-			}
-		}
-		else {
-			Move m = { player, r * 8 + c, (r + dir) * 8 + c, PAWN, PAWN, target_code };
-			moves.push_back(m);
-		}
+//every move returned is legal, so can be played with make_legal_move
+MoveList Board::get_legal_moves(int player) {
+	MoveList moves;
+	MoveMasks masks = get_legal_masks(player);
 
-		// can move 2 on first go
-		if ((player == WHITE && r == 6) || (player == BLACK && r == 1)) {
-			target_code = squares[(r + (dir * 2)) * 8 + c];
-			if (target_code == EMPTY_SQUARE) {
-				Move m = { player, r * 8 + c, (r + (dir * 2)) * 8 + c, PAWN, PAWN, target_code };
-				moves.push_back(m);
-			}
-		}
-	}
+	generate_captures(player, moves, masks);
+	generate_quiets(player, moves, masks);
 
 	return moves;
 }
 
-std::vector<Move> Board::get_knight_moves(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(1, 2), std::make_pair(2, 1),
-												   std::make_pair(-1, 2), std::make_pair(2, -1),
-												   std::make_pair(1, -2), std::make_pair(-2, 1),
-												   std::make_pair(-1, -2), std::make_pair(-2, -1) };
+MoveList Board::get_legal_captures(int player) {
+	MoveList moves;
+	MoveMasks masks = get_legal_masks(player);
 
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
-
-		// make sure we're not trying to move off the board
-		if (r + dir.first < 0 || r + dir.first > 7 || c + dir.second < 0 || c + dir.second > 7) continue;
-
-		int target_square = (r + dir.first) * 8 + c + dir.second;
-		int target_code = squares[target_square];
-		if (target_code == EMPTY_SQUARE) {
-			Move m = { player, r * 8 + c, target_square, KNIGHT, KNIGHT, target_code };
-			moves.push_back(m);
-		}
-	}
+	generate_captures(player, moves, masks);
 
 	return moves;
 }
 
-std::vector<Move> Board::get_bishop_moves(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
+MoveList Board::get_legal_quiets(int player) {
+	MoveList moves;
+	MoveMasks masks = get_legal_masks(player);
 
-	for (int i = 0; i < 4; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
+	generate_quiets(player, moves, masks);
 
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
+	return moves;
+}
 
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
+//checks a move which did not come from generating this position's moves, such as one from the transposition table
+//only the rules for the piece being moved are checked, so this is much cheaper than generating every move and searching for it
+bool Board::is_legal(const Move& m) {
+	int player = white_to_move ? WHITE : BLACK;
+	int opp = white_to_move ? BLACK : WHITE;
+
+	//the move has to describe what is actually on the board
+	if (m.start == m.end || m.player != player) return false;
+	if (squares[m.start] != player * 6 + m.start_type || squares[m.end] != m.prev_square) return false;
+	if (colours[player] & square_bb(m.end)) return false;
+
+	//pawns must promote when reaching the last row, and nothing else can
+	bool promotion_row = m.end / 8 == (player == WHITE ? 0 : 7);
+	if (m.start_type == PAWN) {
+		if (promotion_row != (m.end_type != PAWN) || m.end_type > QUEEN) return false;
+	}
+	else if (m.end_type != m.start_type) {
+		return false;
+	}
 
-			if (target_code == EMPTY_SQUARE) {
-				Move m = { player, r * 8 + c, target_square, BISHOP, BISHOP, target_code };
-				moves.push_back(m);
+	MoveMasks masks = get_legal_masks(player);
+	Bitboard target = square_bb(m.end);
+
+	switch (m.start_type) {
+	case PAWN: {
+		int dir = player == WHITE ? -8 : 8;
+		if (m.end == m.start + dir) {
+			if (occupied & target) return false;
+		}
+		else if (m.end == m.start + dir * 2) {
+			if (m.start / 8 != (player == WHITE ? 6 : 1) || (occupied & (target | square_bb(m.start + dir)))) return false;
+		}
+		else if (bitboards::pawn_attacks[player][m.start] & target) {
+			//en passant is checked the same way as when generating it
+			if (m.end == state().en_passant_target) {
+				if (masks.king == EMPTY_SQUARE) return true;
+				int captured_square = m.end - dir;
+				Bitboard occ = (occupied ^ square_bb(m.start) ^ square_bb(captured_square)) | target;
+				return !(attackers_to(masks.king, occ) & colours[opp] & ~square_bb(captured_square));
 			}
-			else break;
+			if (!(colours[opp] & target)) return false;
 		}
+		else {
+			return false;
+		}
+		return legal_targets(m.start, masks) & target;
+	}
+	case KNIGHT:
+		return (bitboards::knight_attacks[m.start] & target) && (legal_targets(m.start, masks) & target);
+	case BISHOP:
+		return (bitboards::bishop_attacks(m.start, occupied) & target) && (legal_targets(m.start, masks) & target);
+	case ROOK:
+		return (bitboards::rook_attacks(m.start, occupied) & target) && (legal_targets(m.start, masks) & target);
+	case QUEEN:
+		return (bitboards::queen_attacks(m.start, occupied) & target) && (legal_targets(m.start, masks) & target);
+	case KING: {
+		//there are at most two castling moves, so just generate them
+		if (abs(m.end - m.start) == 2) {
+			MoveList castles;
+			get_castling_moves(player, castles, masks);
+			for (const Move& castle : castles) {
+				if (castle.start == m.start && castle.end == m.end) return true;
+			}
+			return false;
+		}
+		if (!(bitboards::king_attacks[m.start] & target)) return false;
+		return masks.king == EMPTY_SQUARE || !(attackers_to(m.end, occupied ^ square_bb(m.start)) & colours[opp]);
+	}
 	}
 
-	return moves;
+	return false;
 }
 
-std::vector<Move> Board::get_rook_moves(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0) };
-
-	for (int i = 0; i < 4; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
-
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
-
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
+Board::MoveMasks Board::get_pseudo_legal_masks() {
+	MoveMasks masks = { EMPTY_SQUARE, ~0ULL, 0, false };
+	return masks;
+}
 
-			if (target_code == EMPTY_SQUARE) {
-				Move m = { player, r * 8 + c, target_square, ROOK, ROOK, target_code };
-				moves.push_back(m);
-			}
-			else break;
+//works out once per position which pieces are pinned and which squares get the king out of check
+Board::MoveMasks Board::get_legal_masks(int player) {
+	//without a king there is nothing to keep safe
+	if (!pieces[player][KING]) return get_pseudo_legal_masks();
+
+	int opp = player == WHITE ? BLACK : WHITE;
+
+	MoveMasks masks;
+	masks.king = lsb(pieces[player][KING]);
+
+	Bitboard checkers = attackers_to(masks.king, occupied) & colours[opp];
+	masks.in_check = checkers != 0;
+
+	//in single check we must capture the checker or block the line between it and the king
+	//in double check only the king can move
+	if (!checkers) masks.check_mask = ~0ULL;
+	else if (!(checkers & (checkers - 1))) masks.check_mask = bitboards::between_bb[masks.king][lsb(checkers)] | checkers;
+	else masks.check_mask = 0;
+
+	//an enemy slider which would attack the king if exactly one of our pieces was removed pins that piece
+	masks.pinned = 0;
+	Bitboard snipers = (bitboards::rook_attacks(masks.king, 0) & (pieces[opp][ROOK] | pieces[opp][QUEEN]))
+		| (bitboards::bishop_attacks(masks.king, 0) & (pieces[opp][BISHOP] | pieces[opp][QUEEN]));
+	while (snipers) {
+		int sniper = pop_lsb(snipers);
+		Bitboard blockers = bitboards::between_bb[masks.king][sniper] & occupied;
+		if (blockers && !(blockers & (blockers - 1)) && (blockers & colours[player])) {
+			masks.pinned |= blockers;
 		}
 	}
 
-	return moves;
+	return masks;
 }
 
-std::vector<Move> Board::get_queen_moves(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0),
-												   std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
+//the squares a piece on square can legally move to, ignoring how the piece itself moves
+Bitboard Board::legal_targets(int square, const MoveMasks& masks) {
+	if (masks.pinned & square_bb(square)) return masks.check_mask & bitboards::line_bb[masks.king][square];
+	return masks.check_mask;
+}
 
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
+void Board::generate_captures(int player, MoveList& moves, const MoveMasks& masks) {
+	Bitboard targets = colours[player == WHITE ? BLACK : WHITE];
 
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
+	get_pawn_captures(player, moves, masks);
+	get_knight_moves(player, targets, moves, masks);
+	get_bishop_moves(player, targets, moves, masks);
+	get_rook_moves(player, targets, moves, masks);
+	get_queen_moves(player, targets, moves, masks);
+	get_king_moves(player, targets, moves, masks);
+}
 
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
+void Board::generate_quiets(int player, MoveList& moves, const MoveMasks& masks) {
+	Bitboard targets = ~occupied;
 
-			if (target_code == EMPTY_SQUARE) {
-				Move m = { player, r * 8 + c, target_square, QUEEN, QUEEN, target_code };
-				moves.push_back(m);
-			}
-			else break;
-		}
-	}
+	get_pawn_moves(player, moves, masks);
+	get_knight_moves(player, targets, moves, masks);
+	get_bishop_moves(player, targets, moves, masks);
+	get_rook_moves(player, targets, moves, masks);
+	get_queen_moves(player, targets, moves, masks);
+	get_king_moves(player, targets, moves, masks);
+	get_castling_moves(player, moves, masks);
+}
 
-	return moves;
+//add a move from start to every square in targets, recording whatever is currently on the target square
+void Board::add_moves(MoveList& moves, int player, int start, int type, Bitboard targets) {
+	while (targets) {
+		int target_square = pop_lsb(targets);
+		Move m = { player, start, target_square, type, type, squares[target_square] };
+		moves.push_back(m);
+	}
 }
 
-std::vector<Move> Board::get_king_moves(int player, int r, int c) {
+void Board::get_pawn_moves(int player, MoveList& moves, const MoveMasks& masks) {
+	int dir = player == WHITE ? -8 : 8;
+	int promotion_row = player == WHITE ? 0 : 7;
 
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0),
-												   std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
+	//a pawn which has moved one square from its starting row is on the row it can move two from
+	Bitboard double_push_row = row_bb(player == WHITE ? 5 : 2);
 
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
+	const int promotion_types[4] = { KNIGHT, BISHOP, ROOK, QUEEN };
 
-		// make sure we're not trying to move off the board
-		if (r + dir.first < 0 || r + dir.first > 7 || c + dir.second < 0 || c + dir.second > 7) continue;
+	//shift every pawn forward at once, keeping only those landing on an empty square
+	Bitboard single_pushes = (player == WHITE ? pieces[player][PAWN] >> 8 : pieces[player][PAWN] << 8) & ~occupied;
+	Bitboard double_pushes = (player == WHITE ? (single_pushes & double_push_row) >> 8 : (single_pushes & double_push_row) << 8) & ~occupied;
 
-		int target_square = (r + dir.first) * 8 + c + dir.second;
-		int target_code = squares[target_square];
+	while (single_pushes) {
+		int target_square = pop_lsb(single_pushes);
+		if (!(legal_targets(target_square - dir, masks) & square_bb(target_square))) continue;
 
-		if (target_code == EMPTY_SQUARE) {
-			Move m = { player, r * 8 + c, target_square, KING, KING, target_code };
-			moves.push_back(m);
-		}
-	}
-
-	//castle left
-	if (can_castle.back()[player][LEFT]) {
-		bool path_clear = true;
-		for (int i = 1; i < c; i++) {
-			if (squares[r * 8 + i] != EMPTY_SQUARE) {
-				path_clear = false;
-				break;
+		// can promote if reach 8th rank
+		if (target_square / 8 == promotion_row) {
+			for (auto& type : promotion_types) {
+				Move m = { player, target_square - dir, target_square, PAWN, type, EMPTY_SQUARE };
+				moves.push_back(m);
 			}
 		}
-		if (path_clear) {
-			Move m = { player, r * 8 + c, r * 8 + 2, KING, KING, EMPTY_SQUARE };
+		else {
+			Move m = { player, target_square - dir, target_square, PAWN, PAWN, EMPTY_SQUARE };
 			moves.push_back(m);
 		}
 	}
 
-	//castle right
-	if (can_castle.back()[player][RIGHT]) {
-		bool path_clear = true;
-		for (int i = c + 1; i < 7; i++) {
-			if (squares[r * 8 + i] != EMPTY_SQUARE) {
-				path_clear = false;
-				break;
-			}
-		}
-		if (path_clear) {
-			Move m = { player, r * 8 + c, r * 8 + 6, KING, KING, EMPTY_SQUARE };
-			moves.push_back(m);
-		}
-	}
+	// can move 2 on first go
+	while (double_pushes) {
+		int target_square = pop_lsb(double_pushes);
+		if (!(legal_targets(target_square - dir * 2, masks) & square_bb(target_square))) continue;
 
-	return moves;
-}
-
-std::vector<Move> Board::get_valid_captures(int player) {
-
-	std::vector<Move> moves;
-
-	for (int r = 0; r < 8; r++) {
-		for (int c = 0; c < 8; c++) {
-
-			int code = squares[r * 8 + c];
-			if (code == EMPTY_SQUARE || code / 6 != player) continue;
-			int type = code % 6;
-
-			std::vector<Move> tmp;
-
-			switch (type) {
-			case PAWN:
-				tmp = get_pawn_captures(player, r, c);
-				break;
-			case KNIGHT:
-				tmp = get_knight_captures(player, r, c);
-				break;
-			case BISHOP:
-				tmp = get_bishop_captures(player, r, c);
-				break;
-			case ROOK:
-				tmp = get_rook_captures(player, r, c);
-				break;
-			case QUEEN:
-				tmp = get_queen_captures(player, r, c);
-				break;
-			case KING:
-				tmp = get_king_captures(player, r, c);
-				break;
-			}
-
-			moves.insert(moves.end(), tmp.begin(), tmp.end());
-		}
+		Move m = { player, target_square - dir * 2, target_square, PAWN, PAWN, EMPTY_SQUARE };
+		moves.push_back(m);
 	}
-
-	return moves;
 }
 
-std::vector<Move> Board::get_pawn_captures(int player, int r, int c) {
-	std::vector<Move> moves;
-	int dir = player == WHITE ? -1 : 1;
+void Board::get_pawn_captures(int player, MoveList& moves, const MoveMasks& masks) {
+	int opp = player == WHITE ? BLACK : WHITE;
+	int promotion_row = player == WHITE ? 0 : 7;
 
-	std::vector<int> promotion_types = { KNIGHT, BISHOP, ROOK, QUEEN };
+	const int promotion_types[4] = { KNIGHT, BISHOP, ROOK, QUEEN };
 
-	// attack towards 8th file
-	if (c != 7) {
-		int target_code = squares[(r + dir) * 8 + c + 1];
-		if ((target_code != EMPTY_SQUARE && target_code / 6 != player) || (r + dir) * 8 + c + 1 == en_passant_target.back()) {
-
-			// can promote if reach 8th rank
-			if (r + dir == 0 || r + dir == 7) {
-				for (auto& type : promotion_types) {
-					Move m = { player, r * 8 + c, (r + dir) * 8 + c + 1, PAWN, type, target_code };
-					moves.push_back(m);
-				}
-			}
-			else {
-				Move m = { player, r * 8 + c, (r + dir) * 8 + c + 1, PAWN, PAWN, target_code };
-				moves.push_back(m);
-			}
-		}
-	}
+	Bitboard pawns = pieces[player][PAWN];
+	while (pawns) {
+		int square = pop_lsb(pawns);
+		Bitboard attacks = bitboards::pawn_attacks[player][square] & colours[opp] & legal_targets(square, masks);
 
-	// attack towards 1st file
-	if (c != 0) {
-		int target_code = squares[(r + dir) * 8 + c - 1];
-		if ((target_code != EMPTY_SQUARE && target_code / 6 != player) || (r + dir) * 8 + c - 1 == en_passant_target.back()) {
+		while (attacks) {
+			int target_square = pop_lsb(attacks);
+			int target_code = squares[target_square];
 
 			// can promote if reach 8th rank
-			if (r + dir == 0 || r + dir == 7) {
+			if (target_square / 8 == promotion_row) {
 				for (auto& type : promotion_types) {
-					Move m = { player, r * 8 + c, (r + dir) * 8 + c - 1, PAWN, type, target_code };
+					Move m = { player, square, target_square, PAWN, type, target_code };
 					moves.push_back(m);
 				}
 			}
 			else {
-				Move m = { player, r * 8 + c, (r + dir) * 8 + c - 1, PAWN, PAWN, target_code };
+				Move m = { player, square, target_square, PAWN, PAWN, target_code };
 				moves.push_back(m);
 			}
 		}
 	}
 
-	return moves;
-}
-
-std::vector<Move> Board::get_knight_captures(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(1, 2), std::make_pair(2, 1),
-												   std::make_pair(-1, 2), std::make_pair(2, -1),
-												   std::make_pair(1, -2), std::make_pair(-2, 1),
-												   std::make_pair(-1, -2), std::make_pair(-2, -1) };
-
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
+	//pawns can also move onto the en passant target, which is empty
+	int target_square = state().en_passant_target;
+	if (target_square == EMPTY_SQUARE) return;
 
-		// make sure we're not trying to move off the board
-		if (r + dir.first < 0 || r + dir.first > 7 || c + dir.second < 0 || c + dir.second > 7) continue;
+	int captured_square = target_square + (player == WHITE ? 8 : -8);
+	Bitboard ep_pawns = bitboards::pawn_attacks[opp][target_square] & pieces[player][PAWN];
+	while (ep_pawns) {
+		int square = pop_lsb(ep_pawns);
 
-		int target_square = (r + dir.first) * 8 + c + dir.second;
-		int target_code = squares[target_square];
-		if (target_code != EMPTY_SQUARE && target_code / 6 != player) {
-			Move m = { player, r * 8 + c, target_square, KNIGHT, KNIGHT, target_code };
-			moves.push_back(m);
+		//two pawns leave the same row at once, so rather than using the masks, check directly that nothing attacks the king afterwards
+		if (masks.king != EMPTY_SQUARE) {
+			Bitboard occ = (occupied ^ square_bb(square) ^ square_bb(captured_square)) | square_bb(target_square);
+			if (attackers_to(masks.king, occ) & colours[opp] & ~square_bb(captured_square)) continue;
 		}
-	}
 
-	return moves;
+		Move m = { player, square, target_square, PAWN, PAWN, EMPTY_SQUARE };
+		moves.push_back(m);
+	}
 }
 
-std::vector<Move> Board::get_bishop_captures(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
-
-	for (int i = 0; i < 4; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
+void Board::get_knight_moves(int player, Bitboard targets, MoveList& moves, const MoveMasks& masks) {
+	//a pinned knight can never stay on the line of its pin
+	Bitboard knights = pieces[player][KNIGHT] & ~masks.pinned;
+	while (knights) {
+		int square = pop_lsb(knights);
+		add_moves(moves, player, square, KNIGHT, bitboards::knight_attacks[square] & targets & masks.check_mask);
+	}
+}
 
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
+void Board::get_bishop_moves(int player, Bitboard targets, MoveList& moves, const MoveMasks& masks) {
+	Bitboard bishops = pieces[player][BISHOP];
+	while (bishops) {
+		int square = pop_lsb(bishops);
+		add_moves(moves, player, square, BISHOP, bitboards::bishop_attacks(square, occupied) & targets & legal_targets(square, masks));
+	}
+}
 
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
+void Board::get_rook_moves(int player, Bitboard targets, MoveList& moves, const MoveMasks& masks) {
+	Bitboard rooks = pieces[player][ROOK];
+	while (rooks) {
+		int square = pop_lsb(rooks);
+		add_moves(moves, player, square, ROOK, bitboards::rook_attacks(square, occupied) & targets & legal_targets(square, masks));
+	}
+}
 
-			if (target_code != EMPTY_SQUARE && target_code / 6 != player) {
-				Move m = { player, r * 8 + c, target_square, BISHOP, BISHOP, target_code };
-				moves.push_back(m);
+void Board::get_queen_moves(int player, Bitboard targets, MoveList& moves, const MoveMasks& masks) {
+	Bitboard queens = pieces[player][QUEEN];
+	while (queens) {
+		int square = pop_lsb(queens);
+		add_moves(moves, player, square, QUEEN, bitboards::queen_attacks(square, occupied) & targets & legal_targets(square, masks));
+	}
+}
 
-				// stop scanning after we hit an opponent
-				break;
+void Board::get_king_moves(int player, Bitboard targets, MoveList& moves, const MoveMasks& masks) {
+	int opp = player == WHITE ? BLACK : WHITE;
+
+	Bitboard kings = pieces[player][KING];
+	while (kings) {
+		int square = pop_lsb(kings);
+		Bitboard attacks = bitboards::king_attacks[square] & targets;
+
+		//the king cannot step onto an attacked square
+		//it is taken off the board first, so it cannot hide from a slider behind itself
+		if (masks.king != EMPTY_SQUARE) {
+			Bitboard occ = occupied ^ square_bb(square);
+			Bitboard candidates = attacks;
+			while (candidates) {
+				int target_square = pop_lsb(candidates);
+				if (attackers_to(target_square, occ) & colours[opp]) attacks &= ~square_bb(target_square);
 			}
-			else if (target_code != EMPTY_SQUARE && target_code / 6 == player) break;
 		}
-	}
 
-	return moves;
+		add_moves(moves, player, square, KING, attacks);
+	}
 }
 
-std::vector<Move> Board::get_rook_captures(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0) };
-
-	for (int i = 0; i < 4; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
-
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
-
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
-
-			if (target_code != EMPTY_SQUARE && target_code / 6 != player) {
-				Move m = { player, r * 8 + c, target_square, ROOK, ROOK, target_code };
+void Board::get_castling_moves(int player, MoveList& moves, const MoveMasks& masks) {
+	//cannot castle out of check
+	if (masks.in_check) return;
+
+	Bitboard kings = pieces[player][KING];
+	while (kings) {
+		int square = pop_lsb(kings);
+		int r = square / 8;
+		int c = square % 8;
+
+		//castle left, every square between the king and the rook must be empty
+		//for legal moves, the king also cannot pass through or land on an attacked square
+		Bitboard left_path = ((1ULL << c) - 2) << (r * 8);
+		if (has_castling_right(player, LEFT) && c > 1 && !(occupied & left_path)) {
+			if (masks.king == EMPTY_SQUARE || (!is_threatened(player, square - 1) && !is_threatened(player, square - 2))) {
+				Move m = { player, square, r * 8 + 2, KING, KING, EMPTY_SQUARE };
 				moves.push_back(m);
-
-				// stop scanning after we hit an opponent
-				break;
 			}
-			else if (target_code != EMPTY_SQUARE && target_code / 6 == player) break;
 		}
-	}
-
-	return moves;
-}
-
-std::vector<Move> Board::get_queen_captures(int player, int r, int c) {
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0),
-												   std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
-
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
-		for (int j = 1; j < 8; j++) {
 
-			// make sure we're not trying to move off the board
-			if (r + dir.first * j < 0 || r + dir.first * j > 7 || c + dir.second * j < 0 || c + dir.second * j > 7) break;
-
-			int target_square = (r + dir.first * j) * 8 + c + dir.second * j;
-			int target_code = squares[target_square];
-
-			if (target_code != EMPTY_SQUARE && target_code / 6 != player) {
-				Move m = { player, r * 8 + c, target_square, QUEEN, QUEEN, target_code };
+		//castle right
+		Bitboard right_path = ((1ULL << 7) - (1ULL << (c + 1))) << (r * 8);
+		if (has_castling_right(player, RIGHT) && c < 6 && !(occupied & right_path)) {
+			if (masks.king == EMPTY_SQUARE || (!is_threatened(player, square + 1) && !is_threatened(player, square + 2))) {
+				Move m = { player, square, r * 8 + 6, KING, KING, EMPTY_SQUARE };
 				moves.push_back(m);
-
-				// stop scanning after we hit an opponent
-				break;
 			}
-			else if (target_code != EMPTY_SQUARE && target_code / 6 == player) break;
 		}
 	}
-
-	return moves;
 }
-
-std::vector<Move> Board::get_king_captures(int player, int r, int c) {
-
-	std::vector<Move> moves;
-	std::vector<std::pair<int, int>> directions = { std::make_pair(0, 1), std::make_pair(0, -1),
-												   std::make_pair(1, 0), std::make_pair(-1, 0),
-												   std::make_pair(1, 1), std::make_pair(-1, -1),
-												   std::make_pair(-1, 1), std::make_pair(1, -1) };
-
-	for (int i = 0; i < 8; i++) {
-		std::pair<int, int> dir = directions[i];
-
-		// make sure we're not trying to move off the board
-		if (r + dir.first < 0 || r + dir.first > 7 || c + dir.second < 0 || c + dir.second > 7) continue;
-
-		int target_square = (r + dir.first) * 8 + c + dir.second;
-		int target_code = squares[target_square];
-
-		if (target_code != EMPTY_SQUARE && target_code / 6 != player) {
-			Move m = { player, r * 8 + c, target_square, KING, KING, target_code };
-			moves.push_back(m);
-		}
-	}
-
-	return moves;
-}
\ No newline at end of file
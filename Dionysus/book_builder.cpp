@@ -0,0 +1,289 @@
+#include "book_builder.h"
+#include "opening_book.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+BookBuilder::BookBuilder(const BookBuilderOptions& options) : options(options) {
+	//largest power of two number of records which fits in the memory allowed
+	size_t records_allowed = ((size_t)std::max(options.hash_megabytes, 1) << 20) / sizeof(BookRecord);
+	capacity = 1;
+	while (capacity * 2 <= records_allowed) capacity *= 2;
+
+	records = std::make_unique<BookRecord[]>(capacity);
+	for (size_t i = 0; i < capacity; i++) records[i].games = 0;
+}
+
+//polyglot keys are already random, so the low bits are spread well enough without any more mixing
+size_t BookBuilder::home_slot(unsigned long long key, unsigned short move) const {
+	return (size_t)(key ^ (move * 0x9E3779B97F4A7C15ULL)) & (capacity - 1);
+}
+
+//linear probing, a slot with no games is empty
+void BookBuilder::insert(const BookRecord& r) {
+	for (size_t i = home_slot(r.key, r.move); ; i = (i + 1) & (capacity - 1)) {
+		BookRecord& slot = records[i];
+		if (slot.games == 0) {
+			slot = r;
+			count++;
+			return;
+		}
+		if (slot.key == r.key && slot.move == r.move) {
+			//once the count is saturated the move stops being counted, which keeps its average score the same
+			if (slot.games + r.games <= 0xFFFF) {
+				slot.games += r.games;
+				slot.score += r.score;
+			}
+			return;
+		}
+	}
+}
+
+//makes room by dropping the moves played in the fewest games, which are the ones least likely to meet the min_games cut anyway
+//a dropped move which turns up again starts counting from scratch, so once anything has been pruned every count can be short by up to pruned_games
+//write leaves out the moves whose counts are no more than that, as they could be nothing but the error
+void BookBuilder::prune() {
+	while (count > capacity / 2) {
+		pruned_games++;
+		for (size_t i = 0; i < capacity; i++) {
+			if (records[i].games != 0 && records[i].games <= pruned_games) {
+				records[i].games = 0;
+				count--;
+			}
+		}
+	}
+
+	//removing records leaves holes in the probe sequences, so every record left is reinserted
+	//starting just after an empty slot means no record's probe sequence wraps past the start, so each one only ever moves back towards its home slot
+	size_t start = 0;
+	while (records[start].games != 0) start++;
+	for (size_t n = 1; n <= capacity; n++) {
+		size_t i = (start + n) & (capacity - 1);
+		if (records[i].games == 0) continue;
+
+		BookRecord r = records[i];
+		records[i].games = 0;
+		count--;
+		insert(r);
+	}
+}
+
+void BookBuilder::add_records(const std::vector<BookRecord>& batch) {
+	for (const BookRecord& r : batch) {
+		insert(r);
+		if (count > capacity / 4 * 3) prune();
+	}
+}
+
+//the moves of one game, up to max_ply, scored for the side which played each one
+//returns false if the game has no result, in which case nothing is added
+//a move which cant be read ends the game there, as nothing after it can be replayed
+bool BookBuilder::replay_game(const std::string& game, std::vector<BookRecord>& out) const {
+	std::istringstream lines(game);
+	std::string line, fen, result, movetext;
+
+	while (std::getline(lines, line)) {
+		if (!line.empty() && line[0] == '[') {
+			size_t name_end = line.find(' ');
+			size_t value_start = line.find('"');
+			size_t value_end = line.rfind('"');
+			if (name_end == std::string::npos || value_start == std::string::npos || value_end <= value_start) continue;
+
+			std::string name = line.substr(1, name_end - 1);
+			std::string value = line.substr(value_start + 1, value_end - value_start - 1);
+			if (name == "FEN") fen = value;
+			else if (name == "Result") result = value;
+		}
+		else {
+			//a semicolon comments out the rest of the line
+			movetext += line.substr(0, line.find(';')) + " ";
+		}
+	}
+
+	//comments and variations are dropped, the book only follows the moves actually played
+	std::string moves_only;
+	int comment_depth = 0, variation_depth = 0;
+	for (char c : movetext) {
+		if (c == '{') comment_depth++;
+		else if (c == '}') comment_depth = std::max(comment_depth - 1, 0);
+		else if (comment_depth > 0) continue;
+		else if (c == '(') variation_depth++;
+		else if (c == ')') variation_depth = std::max(variation_depth - 1, 0);
+		else if (variation_depth == 0) moves_only += c;
+	}
+
+	std::vector<std::string> sans;
+	std::istringstream tokens(moves_only);
+	std::string token;
+	while (std::getline(tokens, token, ' ')) {
+		if (token.empty() || token[0] == '$') continue;
+		if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+			if (result.empty()) result = token;
+			continue;
+		}
+
+		//move numbers can be stuck to the move, as in 1.e4 or 3...Nf6
+		size_t move_start = token.find_first_not_of("0123456789.");
+		if (move_start == std::string::npos) continue;
+		sans.push_back(token.substr(move_start));
+	}
+
+	int white_score;
+	if (result == "1-0") white_score = 2;
+	else if (result == "1/2-1/2") white_score = 1;
+	else if (result == "0-1") white_score = 0;
+	else return false;
+
+	Board board = fen.empty() ? Board() : Board(fen);
+	for (int ply = 0; ply < (int)sans.size() && ply < options.max_ply; ply++) {
+		PackedMove pm = create_move_from_san(sans[ply], &board);
+		if (pm == NULL_MOVE) break;
+
+		Move m = board.unpack_move(pm);
+		BookRecord r;
+		r.key = board.get_zobrist_hash();
+		r.move = OpeningBook::polyglot_move_code(m);
+		r.score = board.is_white_to_move() ? white_score : 2 - white_score;
+		r.games = 1;
+		out.push_back(r);
+
+		board.make_move(m);
+	}
+
+	return true;
+}
+
+//one thread reads the stream and splits it into games, handing them out GAMES_PER_CHUNK at a time
+//the workers replay them and merge the moves into the table a chunk at a time, so the table lock is rarely contended
+//the queue only holds a couple of chunks per worker, so memory stays bounded however far the reader gets ahead
+void BookBuilder::add_games(std::istream& in) {
+	int thread_count = options.threads > 0 ? options.threads : std::max((int)std::thread::hardware_concurrency(), 1);
+	size_t max_queued = thread_count * 2;
+
+	std::deque<std::vector<std::string>> queue;
+	bool done = false;
+	std::mutex queue_mutex, table_mutex;
+	std::condition_variable queue_condition;
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < thread_count; t++) {
+		workers.emplace_back([&] {
+			std::vector<BookRecord> batch;
+			while (true) {
+				std::vector<std::string> chunk;
+				{
+					std::unique_lock<std::mutex> lock(queue_mutex);
+					queue_condition.wait(lock, [&] { return !queue.empty() || done; });
+					if (queue.empty()) return;
+					chunk = std::move(queue.front());
+					queue.pop_front();
+				}
+				queue_condition.notify_all();
+
+				batch.clear();
+				unsigned long long skipped = 0;
+				for (const std::string& game : chunk) {
+					if (!replay_game(game, batch)) skipped++;
+				}
+
+				std::lock_guard<std::mutex> lock(table_mutex);
+				add_records(batch);
+				games_read += chunk.size();
+				games_skipped += skipped;
+			}
+		});
+	}
+
+	auto push_chunk = [&](std::vector<std::string>& chunk) {
+		std::unique_lock<std::mutex> lock(queue_mutex);
+		queue_condition.wait(lock, [&] { return queue.size() < max_queued; });
+		queue.push_back(std::move(chunk));
+		chunk.clear();
+		lock.unlock();
+		queue_condition.notify_all();
+	};
+
+	//a tag after some movetext is the start of the next game
+	std::vector<std::string> chunk;
+	std::string line, game;
+	bool has_moves = false;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+
+		if (!line.empty() && line[0] == '[' && has_moves) {
+			chunk.push_back(std::move(game));
+			game.clear();
+			has_moves = false;
+			if (chunk.size() == GAMES_PER_CHUNK) push_chunk(chunk);
+		}
+		if (!line.empty() && line[0] != '[') has_moves = true;
+		game += line + "\n";
+	}
+	if (has_moves) chunk.push_back(std::move(game));
+	if (!chunk.empty()) push_chunk(chunk);
+
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		done = true;
+	}
+	queue_condition.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+bool BookBuilder::write(const std::string& path) {
+	//move the records which make the cut to the front of the table, and sort them there rather than copying them out
+	size_t kept = 0;
+	for (size_t i = 0; i < capacity; i++) {
+		const BookRecord& r = records[i];
+		if (r.games != 0 && r.games >= options.min_games && r.games > pruned_games && r.score > 0) records[kept++] = r;
+	}
+
+	std::sort(records.get(), records.get() + kept, [](const BookRecord& a, const BookRecord& b) {
+		if (a.key != b.key) return a.key < b.key;
+		return a.score > b.score;
+	});
+
+	std::ofstream file(path, std::ios::binary);
+	if (file) {
+		for (size_t i = 0; i < kept; ) {
+			//the best move in each position gets the top weight, and the others are scaled to match, never reaching 0
+			size_t end = i;
+			while (end < kept && records[end].key == records[i].key) end++;
+			unsigned long long best_score = records[i].score;
+
+			for (; i < end; i++) {
+				unsigned long long key = endian_swap_u64(records[i].key);
+				unsigned short move = endian_swap_u16(records[i].move);
+				unsigned short weight = endian_swap_u16((unsigned short)std::max(records[i].score * 0xFFFFULL / best_score, 1ULL));
+				unsigned int learn = 0;
+				file.write((const char*)&key, sizeof(key));
+				file.write((const char*)&move, sizeof(move));
+				file.write((const char*)&weight, sizeof(weight));
+				file.write((const char*)&learn, sizeof(learn));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < capacity; i++) records[i].games = 0;
+	count = 0;
+
+	return (bool)file;
+}
+
+unsigned long long BookBuilder::get_games_read() const {
+	return games_read;
+}
+
+unsigned long long BookBuilder::get_games_skipped() const {
+	return games_skipped;
+}
+
+size_t BookBuilder::get_entries() const {
+	return count;
+}
\ No newline at end of file
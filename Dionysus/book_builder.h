@@ -0,0 +1,74 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+#define DEFAULT_BOOK_PLY 30
+#define DEFAULT_BOOK_HASH_MEGABYTES 256
+
+//how many games the reader hands to a worker at a time
+#define GAMES_PER_CHUNK 256
+
+struct BookBuilderOptions {
+	//only the first max_ply moves of each game go in the book
+	int max_ply = DEFAULT_BOOK_PLY;
+
+	//moves played in fewer games than this are left out of the book
+	int min_games = 1;
+
+	//worker threads replaying games, 0 for one per core
+	int threads = 0;
+
+	//size of the table the moves are counted in, which is all the memory the builder needs however many games it reads
+	int hash_megabytes = DEFAULT_BOOK_HASH_MEGABYTES;
+};
+
+//builds a polyglot opening book from pgn games
+//every game is replayed on a Board to get the polyglot key (its zobrist hash) of each position, and each move is scored 2 for a win and 1 for a draw for the side playing it
+//the scores are added up in a fixed size open addressed table, so a collection of any size can be read in one pass
+class BookBuilder {
+
+	//one (position, move) pair, the table is sized so that these pack exactly into it
+	struct BookRecord {
+		unsigned long long key;
+		unsigned int score;
+		unsigned short move;
+		unsigned short games;
+	};
+
+	BookBuilderOptions options;
+	std::unique_ptr<BookRecord[]> records;
+	size_t capacity;
+	size_t count = 0;
+
+	//moves played in this many games or fewer have been dropped to make room, so can be missing from the book
+	//a dropped move can come back and count up again from nothing, so no count is trusted unless it is above this
+	int pruned_games = 0;
+
+	unsigned long long games_read = 0;
+	unsigned long long games_skipped = 0;
+
+	size_t home_slot(unsigned long long, unsigned short) const;
+	void insert(const BookRecord&);
+	void prune();
+	void add_records(const std::vector<BookRecord>&);
+	bool replay_game(const std::string&, std::vector<BookRecord>&) const;
+
+public:
+	BookBuilder(const BookBuilderOptions& options = BookBuilderOptions());
+
+	//reads every game from the stream, replaying them on the worker threads while the next ones are read
+	void add_games(std::istream&);
+
+	//writes the book sorted by key, with each position's weights scaled to fit in 16 bits, returns false if the file couldnt be written
+	//the table is sorted in place to do this, so it is emptied afterwards
+	bool write(const std::string&);
+
+	unsigned long long get_games_read() const;
+	unsigned long long get_games_skipped() const;
+	size_t get_entries() const;
+};
\ No newline at end of file
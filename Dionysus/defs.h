@@ -13,8 +13,21 @@
 #define RIGHT 1 //kingside
 #define LEFT 0 //queenside
 
+//castling rights are stored as a bitmask, one bit per player and side
+#define CASTLING_RIGHT(player, dir) (1 << ((player) * 2 + (dir)))
+
 #define EMPTY_SQUARE -1
 
+//deepest the search can go below the root
+#define MAX_PLY 128
+
+//scores are whole centipawns, from the point of view of the side to move, and always fit in 16 bits
+//being checkmated n plies from the root scores -(MATE_SCORE - n), so quicker mates score further from zero
+#define DRAW_SCORE 0
+#define MATE_SCORE 32000
+#define MATE_BOUND (MATE_SCORE - MAX_PLY) //any score at least this far from zero is a forced mate
+#define INFINITE_SCORE 32001
+
 //for coloring cout in print_board()
 #define RESET   "\033[0m"
 #define RED     "\033[31m"      
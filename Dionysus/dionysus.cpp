@@ -1,27 +1,132 @@
 #include <iostream>
-#include <thread>
+#include <algorithm>
+#include <memory>
+#include <sstream>
 #include <stdio.h>
 
 #include "board.h"
 #include "move.h"
 #include "utils.h"
 #include "searcher.h"
+#include "perft.h"
+#include "bench.h"
 #include "defs.h"
 
 Board board;
-Searcher searcher;
 
-void perform_search() {
-	Move m = searcher.get_best_move(5000, &board);
-	std::cout << "bestmove " << create_lan_from_move(m) << std::endl;
+//only made once the uci loop starts, so a bench from the command line doesnt open the book or allocate a table it wont use
+std::unique_ptr<Searcher> searcher;
+
+//whether the gui will let us ponder, in which case it wants to know the reply we expect
+bool ponder_enabled = false;
+
+//called on the main search thread once the search is over
+void report_best_move(PackedMove m, PackedMove ponder) {
+	std::cout << "bestmove " << create_lan_from_move(m);
+	if (ponder_enabled && ponder != NULL_MOVE) std::cout << " ponder " << create_lan_from_move(ponder);
+	std::cout << std::endl;
 }
 
-void process_UCI() {
-	std::string instruction, command;
-	std::thread searching_thread;
+//perft <depth> [threads <n>] [hash <megabytes>] [scaling]
+//with scaling, the same perft is timed on 1, 2, 4... up to n threads instead of printing the divide
+void run_perft(std::string args) {
+	std::istringstream stream(args);
+	int depth = 0;
+	int threads = 1;
+	int hash_megabytes = 0;
+	bool scaling = false;
+
+	stream >> depth;
+	std::string option;
+	while (stream >> option) {
+		if (option == "threads") stream >> threads;
+		else if (option == "hash") stream >> hash_megabytes;
+		else if (option == "scaling") scaling = true;
+	}
+
+	threads = std::max(threads, 1);
+	if (scaling) perft_scaling(&board, depth, threads, hash_megabytes);
+	else perft_divide(&board, depth, threads, hash_megabytes);
+}
+
+//bench [depth]
+void run_bench(std::string args) {
+	int depth = DEFAULT_BENCH_DEPTH;
+	std::istringstream(args) >> depth;
+	bench(std::max(depth, 1));
+}
+
+//go [ponder] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [movetime <ms>] [depth <n>] [nodes <n>] [infinite]
+//with none of them, the search gets a fixed DEFAULT_MOVE_TIME
+SearchLimits parse_limits(std::string args) {
+	std::istringstream stream(args);
+	SearchLimits limits;
 
-	bool first_search = true;
+	std::string option;
+	while (stream >> option) {
+		if (option == "wtime") stream >> limits.time[WHITE];
+		else if (option == "btime") stream >> limits.time[BLACK];
+		else if (option == "winc") stream >> limits.increment[WHITE];
+		else if (option == "binc") stream >> limits.increment[BLACK];
+		else if (option == "movestogo") stream >> limits.moves_to_go;
+		else if (option == "movetime") stream >> limits.move_time;
+		else if (option == "depth") stream >> limits.depth;
+		else if (option == "nodes") stream >> limits.nodes;
+		else if (option == "infinite") limits.infinite = true;
+		else if (option == "ponder") limits.ponder = true;
+	}
+
+	bool limited = limits.time[WHITE] > 0 || limits.time[BLACK] > 0 || limits.move_time > 0 || limits.depth > 0 || limits.nodes > 0 || limits.infinite;
+	if (!limited) limits.move_time = DEFAULT_MOVE_TIME;
+
+	return limits;
+}
+
+//setoption name <name> [value <value>]
+//option names can contain spaces, so the name is everything up to "value"
+void set_option(std::string args) {
+	size_t name_start = args.find("name ");
+	if (name_start == std::string::npos) return;
+	name_start += 5;
+
+	size_t value_start = args.find(" value ", name_start);
+	std::string name = args.substr(name_start, value_start == std::string::npos ? std::string::npos : value_start - name_start);
+	std::string value = value_start == std::string::npos ? "" : args.substr(value_start + 7);
+
+	if (name == "Threads") {
+		int threads = 1;
+		std::istringstream(value) >> threads;
+		searcher->set_threads(std::min(std::max(threads, 1), MAX_THREADS));
+	}
+	else if (name == "Ponder") {
+		ponder_enabled = value == "true";
+	}
+	else if (name == "Move Overhead") {
+		int milliseconds = DEFAULT_MOVE_OVERHEAD;
+		std::istringstream(value) >> milliseconds;
+		searcher->set_move_overhead(std::min(std::max(milliseconds, 0), MAX_MOVE_OVERHEAD));
+	}
+	else if (name == "Hash") {
+		int megabytes = DEFAULT_HASH_MEGABYTES;
+		std::istringstream(value) >> megabytes;
+		searcher->set_hash_size(std::min(std::max(megabytes, MIN_HASH_MEGABYTES), MAX_HASH_MEGABYTES));
+	}
+	else if (name == "Clear Hash") {
+		searcher->clear_hash();
+	}
+	else if (name == "OwnBook") {
+		searcher->set_own_book(value == "true");
+	}
+	else if (name == "BookFile") {
+		searcher->set_book_file(value);
+	}
+	else {
+		std::cout << "*Unrecognised option " << name << std::endl;
+	}
+}
 
+void process_UCI() {
+	std::string instruction, command;
 	//read each instruction
 	while (std::getline(std::cin, instruction)) {
 
@@ -29,17 +134,29 @@ void process_UCI() {
 		command = instruction.substr(0, instruction.find(' '));
 
 		//pos keeps track of current position while parsing each instruction
-		int pos = command.size() + 1;
+		size_t pos = command.size() + 1;
 
 		//respond to uci with name and author
 		if (command == "uci") {
 			std::cout << "id name Dionysus \nid author Thomas Patterson\n";
+			std::cout << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << "\n";
+			std::cout << "option name Ponder type check default false\n";
+			std::cout << "option name Move Overhead type spin default " << DEFAULT_MOVE_OVERHEAD << " min 0 max " << MAX_MOVE_OVERHEAD << "\n";
+			std::cout << "option name Hash type spin default " << DEFAULT_HASH_MEGABYTES << " min " << MIN_HASH_MEGABYTES << " max " << MAX_HASH_MEGABYTES << "\n";
+			std::cout << "option name Clear Hash type button\n";
+			std::cout << "option name OwnBook type check default true\n";
+			std::cout << "option name BookFile type string default " << BOOK_NAME << "\n";
 			std::cout << "uciok" << std::endl;
 		}
 		//respond to isready with readyok, as per spec
 		else if (command == "isready") {
 			std::cout << "readyok" << std::endl;
 		}
+		//ucinewgame means the next position is from a different game
+		else if (command == "ucinewgame") {
+			searcher->wait();
+			searcher->new_game();
+		}
 		//position specifies current board position
 		else if (command == "position") {
 			std::string type = instruction.substr(pos, instruction.find(' ', pos) - pos);
@@ -71,24 +188,51 @@ void process_UCI() {
 				while (pos < instruction.size()) {
 					move = instruction.substr(pos, instruction.find(' ', pos) - pos);
 					pos += move.size() + 1;
-					Move m = create_move_from_lan(move, &board);
-					board.make_move(m);
+					board.make_move(board.unpack_move(create_move_from_lan(move)));
 				}
 			}
 		}
 
 		//when recieve go, start searching on currently loaded position
 		else if (command == "go") {
-			//need to join thread from previous search before we can start this one
-			if (first_search) first_search = false;
-			else searching_thread.join();
+			//need to wait for the previous search to finish before we can start this one
+			searcher->wait();
 
-			searching_thread = std::thread(perform_search);
+			//go perft n runs perft to depth n instead of searching
+			if (pos < instruction.size() && instruction.compare(pos, 5, "perft") == 0) {
+				run_perft(pos + 6 < instruction.size() ? instruction.substr(pos + 6) : "");
+			}
+			else {
+				searcher->start_search(parse_limits(pos < instruction.size() ? instruction.substr(pos) : ""), board, report_best_move);
+			}
+		}
+
+		//perft n counts the leaves of the move tree to depth n, for checking and timing move generation
+		else if (command == "perft") {
+			searcher->wait();
+			run_perft(pos < instruction.size() ? instruction.substr(pos) : "");
+		}
+
+		//bench searches a fixed set of positions, to time the search and check it still searches the same tree
+		else if (command == "bench") {
+			searcher->wait();
+			run_bench(pos < instruction.size() ? instruction.substr(pos) : "");
+		}
+
+		//setoption changes one of the options listed in response to uci, never sent while searching
+		else if (command == "setoption") {
+			searcher->wait();
+			set_option(pos < instruction.size() ? instruction.substr(pos) : "");
+		}
+
+		//ponderhit means the opponent played the move we were pondering on, so the search becomes a normal one
+		else if (command == "ponderhit") {
+			searcher->ponderhit();
 		}
 
 		//stop indicates we should stop searching
 		else if (command == "stop") {
-			searcher.stop();
+			searcher->stop();
 		}
 
 		//quit indicates we should end program
@@ -102,10 +246,18 @@ void process_UCI() {
 		}
 	}
 	
-	//when exiting program
-	searching_thread.detach();
+	//when exiting program, stop any search still running so it has finished before the searcher is destroyed
+	searcher->stop();
+	searcher->wait();
 }
 
-int main() {	
+//dionysus bench [depth] runs the bench and exits, without waiting for a gui
+int main(int argc, char* argv[]) {
+	if (argc > 1 && std::string(argv[1]) == "bench") {
+		run_bench(argc > 2 ? argv[2] : "");
+		return 0;
+	}
+
+	searcher = std::make_unique<Searcher>();
 	process_UCI();
 }
\ No newline at end of file
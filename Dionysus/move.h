@@ -1,8 +1,44 @@
 #pragma once
 
+#include "defs.h"
+
+//everything make_move and undo_move need, so nothing has to be looked up on the board
+//each field fits in a byte, which keeps move lists small
 struct Move {
-	int player;
-	int start, end;
-	int start_type, end_type;
-	int prev_square;
-};
\ No newline at end of file
+	signed char player;
+	signed char start, end;
+	signed char start_type, end_type;
+	signed char prev_square;
+
+	Move() = default;
+	Move(int player, int start, int end, int start_type, int end_type, int prev_square)
+		: player(player), start(start), end(end), start_type(start_type), end_type(end_type), prev_square(prev_square) { }
+};
+
+//a move squeezed into 16 bits, for storing in the transposition table and passing results around the search
+//bits 0-5 are the start square, bits 6-11 the end square and bits 12-14 the piece promoted to (PAWN if not a promotion)
+//the rest of the move can be recovered from the board with Board::unpack_move
+typedef unsigned short PackedMove;
+
+//starts and ends on the same square, so can never be a real move
+#define NULL_MOVE 0
+
+inline PackedMove pack_move(int start, int end, int promotion = PAWN) {
+	return (PackedMove)(start | (end << 6) | (promotion << 12));
+}
+
+inline PackedMove pack_move(const Move& m) {
+	return pack_move(m.start, m.end, m.start_type != m.end_type ? m.end_type : PAWN);
+}
+
+inline int packed_start(PackedMove m) {
+	return m & 63;
+}
+
+inline int packed_end(PackedMove m) {
+	return (m >> 6) & 63;
+}
+
+inline int packed_promotion(PackedMove m) {
+	return m >> 12;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "move.h"
+
+//no legal chess position has more moves than this
+#define MAX_MOVES 256
+
+//fixed capacity list of moves which lives on the stack, so that generating moves never needs to allocate
+struct MoveList {
+	Move moves[MAX_MOVES];
+	int count = 0;
+
+	void push_back(const Move& m) {
+		moves[count++] = m;
+	}
+
+	void clear() {
+		count = 0;
+	}
+
+	int size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	Move& operator[](int i) {
+		return moves[i];
+	}
+
+	const Move& operator[](int i) const {
+		return moves[i];
+	}
+
+	Move* begin() {
+		return moves;
+	}
+
+	Move* end() {
+		return moves + count;
+	}
+
+	const Move* begin() const {
+		return moves;
+	}
+
+	const Move* end() const {
+		return moves + count;
+	}
+};
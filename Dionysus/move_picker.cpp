@@ -0,0 +1,130 @@
+#include "move_picker.h"
+
+#include <algorithm>
+
+MovePicker::MovePicker(Board* board, PackedMove tt_move, const PackedMove* killers) : board(board), tt_move(tt_move) {
+	player = board->is_white_to_move() ? WHITE : BLACK;
+	stage = STAGE_TT_MOVE;
+	captures_only = false;
+
+	this->killers[0] = killers ? killers[0] : NULL_MOVE;
+	this->killers[1] = killers ? killers[1] : NULL_MOVE;
+}
+
+MovePicker::MovePicker(Board* board) : board(board), tt_move(NULL_MOVE) {
+	player = board->is_white_to_move() ? WHITE : BLACK;
+	stage = STAGE_GENERATE_CAPTURES;
+	captures_only = true;
+
+	killers[0] = NULL_MOVE;
+	killers[1] = NULL_MOVE;
+}
+
+//most valuable victim, least valuable attacker
+//en passant captures have no piece on the target square, but always take a pawn
+void MovePicker::score_captures() {
+	for (int i = 0; i < moves.size(); i++) {
+		const Move& m = moves[i];
+		int victim = m.prev_square != EMPTY_SQUARE ? m.prev_square % 6 : PAWN;
+		scores[i] = victim * 8 + (m.end_type - m.start_type) * 8 - m.start_type;
+	}
+}
+
+//selection sort one move at a time, since usually only the first few are ever needed
+Move MovePicker::pick_best() {
+	int best = current;
+	for (int i = current + 1; i < moves.size(); i++) {
+		if (scores[i] > scores[best]) best = i;
+	}
+
+	std::swap(moves[current], moves[best]);
+	std::swap(scores[current], scores[best]);
+
+	return moves[current++];
+}
+
+bool MovePicker::is_killer(const Move& m) {
+	PackedMove pm = pack_move(m);
+	return pm == killers[0] || pm == killers[1];
+}
+
+bool MovePicker::next(Move& m) {
+	switch (stage) {
+	case STAGE_TT_MOVE:
+		stage = STAGE_GENERATE_CAPTURES;
+		if (tt_move != NULL_MOVE) {
+			//packing the move again catches promotion bits on a move which is not a promotion
+			m = board->unpack_move(tt_move);
+			if (pack_move(m) == tt_move && board->is_legal(m)) return true;
+			tt_move = NULL_MOVE;
+		}
+		//fall through
+
+	case STAGE_GENERATE_CAPTURES:
+		moves = board->get_legal_captures(player);
+		score_captures();
+		current = 0;
+		stage = STAGE_GOOD_CAPTURES;
+		//fall through
+
+	case STAGE_GOOD_CAPTURES:
+		while (current < moves.size()) {
+			m = pick_best();
+			if (pack_move(m) == tt_move) continue;
+
+			//captures which lose material are saved for last
+			if (board->see(m) < 0) {
+				bad_captures.push_back(m);
+				continue;
+			}
+			return true;
+		}
+		if (captures_only) {
+			stage = STAGE_BAD_CAPTURES;
+			return next(m);
+		}
+		stage = STAGE_KILLERS;
+		//fall through
+
+	case STAGE_KILLERS:
+		while (killer_index < 2) {
+			PackedMove killer = killers[killer_index++];
+			if (killer == NULL_MOVE || killer == tt_move) continue;
+
+			//a killer came from a different position, so may not be a legal quiet move here
+			m = board->unpack_move(killer);
+			bool quiet = m.prev_square == EMPTY_SQUARE && !(m.start_type == PAWN && (m.end - m.start) % 8 != 0);
+			if (quiet && pack_move(m) == killer && board->is_legal(m)) return true;
+		}
+		stage = STAGE_GENERATE_QUIETS;
+		//fall through
+
+	case STAGE_GENERATE_QUIETS:
+		moves = board->get_legal_quiets(player);
+		current = 0;
+		stage = STAGE_QUIETS;
+		//fall through
+
+	case STAGE_QUIETS:
+		while (current < moves.size()) {
+			m = moves[current++];
+			if (pack_move(m) == tt_move || is_killer(m)) continue;
+			return true;
+		}
+		stage = STAGE_BAD_CAPTURES;
+		//fall through
+
+	case STAGE_BAD_CAPTURES:
+		if (bad_current < bad_captures.size()) {
+			m = bad_captures[bad_current++];
+			return true;
+		}
+		stage = STAGE_DONE;
+		//fall through
+
+	case STAGE_DONE:
+		return false;
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "board.h"
+
+//the groups of moves a MovePicker hands out, in order
+#define STAGE_TT_MOVE 0
+#define STAGE_GENERATE_CAPTURES 1
+#define STAGE_GOOD_CAPTURES 2
+#define STAGE_KILLERS 3
+#define STAGE_GENERATE_QUIETS 4
+#define STAGE_QUIETS 5
+#define STAGE_BAD_CAPTURES 6
+#define STAGE_DONE 7
+
+//hands out the legal moves of a position one at a time, the moves most likely to be best first
+//each group is only generated once everything before it has been tried, so a node which cuts off early never pays for the rest
+//  the transposition table move, checked directly on the board
+//  captures which do not lose material, most valuable victim first
+//  killer moves, quiet moves which caused a cut off in another node at the same ply
+//  the remaining quiet moves
+//  captures which lose material
+class MovePicker {
+
+	Board* board;
+	int player;
+	int stage;
+	bool captures_only;
+
+	PackedMove tt_move;
+	PackedMove killers[2];
+	int killer_index = 0;
+
+	MoveList moves;
+	int scores[MAX_MOVES];
+	int current = 0;
+
+	MoveList bad_captures;
+	int bad_current = 0;
+
+	void score_captures();
+	Move pick_best();
+	bool is_killer(const Move&);
+
+public:
+	//killers can be nullptr if there are none
+	MovePicker(Board*, PackedMove, const PackedMove*);
+
+	//only captures, for quiescence search
+	MovePicker(Board*);
+
+	//false once every move has been handed out
+	bool next(Move&);
+};
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "opening_book.h"
+#include "utils.h"
+
+#include <random>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+OpeningBook::~OpeningBook() {
+	close();
+}
+
+bool OpeningBook::open(const std::string& path) {
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(BookEntry)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view) {
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	file_handle = file;
+	mapping_handle = mapping;
+	entries = (const BookEntry*)view;
+	book_size = (size_t)size.QuadPart / sizeof(BookEntry);
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size < (off_t)sizeof(BookEntry)) {
+		::close(file);
+		return false;
+	}
+
+	//the mapping keeps the file alive, so the descriptor isnt needed once it is made
+	void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, file, 0);
+	::close(file);
+	if (view == MAP_FAILED) return false;
+
+	mapped_bytes = info.st_size;
+	entries = (const BookEntry*)view;
+	book_size = (size_t)info.st_size / sizeof(BookEntry);
+#endif
+
+	return true;
+}
+
+void OpeningBook::close() {
+	if (!entries) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(entries);
+	CloseHandle(mapping_handle);
+	CloseHandle(file_handle);
+	file_handle = mapping_handle = nullptr;
+#else
+	munmap((void*)entries, mapped_bytes);
+	mapped_bytes = 0;
+#endif
+
+	entries = nullptr;
+	book_size = 0;
+}
+
+bool OpeningBook::is_open() const {
+	return entries != nullptr;
+}
+
+PackedMove OpeningBook::probe(Board* board) {
+	if (!entries) return NULL_MOVE;
+
+	//binary search for the first entry for this position
+	unsigned long long key = board->get_zobrist_hash();
+	size_t low = 0, high = book_size;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		if (endian_swap_u64(entries[mid].key) < key) low = mid + 1;
+		else high = mid;
+	}
+
+	//a corrupt entry, or another position with the same key, can give a move which cant be played here, so those are skipped as if their weight was 0
+	auto legal_move = [this, board](size_t i) {
+		PackedMove pm = decipher_polyglot_move_code(endian_swap_u16(entries[i].move), board);
+		if (pack_move(board->unpack_move(pm)) != pm || !board->is_legal(board->unpack_move(pm))) return (PackedMove)NULL_MOVE;
+		return pm;
+	};
+
+	//the fields are only ever swapped into locals, the mapping is read only
+	size_t end = low;
+	int total_weight = 0;
+	for (; end < book_size && endian_swap_u64(entries[end].key) == key; end++) {
+		if (legal_move(end) != NULL_MOVE) total_weight += endian_swap_u16(entries[end].weight);
+	}
+	if (total_weight == 0) return NULL_MOVE;
+
+	//choose a random one based on the weighting of each entry, so a move with weight 0 is never played
+	std::random_device rd;
+	std::mt19937 gen(rd());
+	std::uniform_int_distribution<> distr(1, total_weight);
+	int r = distr(gen);
+
+	int cum_weight = 0;
+	for (size_t i = low; i < end; i++) {
+		PackedMove pm = legal_move(i);
+		if (pm == NULL_MOVE) continue;
+		cum_weight += endian_swap_u16(entries[i].weight);
+		if (cum_weight >= r) return pm;
+	}
+	return NULL_MOVE;
+}
+
+unsigned short OpeningBook::polyglot_move_code(const Move& m) {
+	int end = m.end;
+
+	//castling is stored as the king taking its own rook
+	if (m.start_type == KING && (m.end - m.start == 2 || m.end - m.start == -2)) {
+		end = m.end > m.start ? m.start + 3 : m.start - 4;
+	}
+
+	int promotion = m.end_type != m.start_type ? m.end_type : 0;
+	return (unsigned short)((end % 8) | (7 - end / 8) << 3 | (m.start % 8) << 6 | (7 - m.start / 8) << 9 | promotion << 12);
+}
+
+//polyglot moves use the same fields as PackedMove, but count rows from white's side and number promotion pieces from knight = 1, as we do
+PackedMove OpeningBook::decipher_polyglot_move_code(unsigned short code, Board *board) {
+
+	//extract each piece of information from bit field
+	int dst_file = (code >> 0) & 7;
+	int dst_row = (code >> 3) & 7;
+	int src_file = (code >> 6) & 7;
+	int src_row = (code >> 9) & 7;
+	int prom_pc = (code >> 12) & 7;
+
+	//convert row/file to the index in board's representation
+	int src_code = (7 - src_row) * 8 + src_file;
+	int dst_code = (7 - dst_row) * 8 + dst_file;
+
+	//castling is stored as the king taking its own rook, so change the target square to just 2 squares along instead of on the rook
+	bool king_on_start = board->get_square(src_code) != EMPTY_SQUARE && board->get_square(src_code) % 6 == KING;
+	if (king_on_start && (src_code == 4 || src_code == 60) && (dst_code == src_code - 4 || dst_code == src_code + 3)) {
+		dst_code = src_code + (dst_code > src_code ? 2 : -2);
+	}
+
+	return pack_move(src_code, dst_code, prom_pc);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+
+#include "board.h"
+
+//a polyglot opening book (http://hgm.nubati.net/book_format.html), memory mapped read only rather than read in
+//nothing is copied at startup, and every engine process on the machine using the same book shares the one copy in the page cache
+class OpeningBook {
+
+	//one 16 byte record, every field is stored big endian
+	//the records are sorted by key, so all the moves for a position are next to each other
+	struct BookEntry {
+		unsigned long long key;
+		unsigned short move;
+		unsigned short weight;
+		unsigned int learn;
+	};
+
+	const BookEntry* entries = nullptr;
+	size_t book_size = 0;
+
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#else
+	size_t mapped_bytes = 0;
+#endif
+
+	PackedMove decipher_polyglot_move_code(unsigned short, Board*);
+
+public:
+	OpeningBook() = default;
+	~OpeningBook();
+
+	OpeningBook(const OpeningBook&) = delete;
+	OpeningBook& operator=(const OpeningBook&) = delete;
+
+	//maps the book at path, closing any book which was already open, returns false if it couldnt be opened
+	bool open(const std::string&);
+	void close();
+	bool is_open() const;
+
+	//a random book move for the position, chosen in proportion to the weights, or NULL_MOVE if the position isnt in the book
+	//moves which arent legal in the position are never returned
+	PackedMove probe(Board*);
+
+	//the polyglot code for a move, the opposite of decipher_polyglot_move_code
+	static unsigned short polyglot_move_code(const Move&);
+};
\ No newline at end of file
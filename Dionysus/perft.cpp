@@ -0,0 +1,176 @@
+#include "perft.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+PerftTable::PerftTable(int megabytes) {
+	//largest power of two number of entries which fits in the memory given
+	unsigned long long size = 1;
+	while (size * 2 * sizeof(Entry) <= (unsigned long long)megabytes * 1024 * 1024) size *= 2;
+
+	entries = std::unique_ptr<Entry[]>(new Entry[size]());
+	mask = size - 1;
+}
+
+bool PerftTable::probe(unsigned long long hash, int depth, unsigned long long& count) {
+	unsigned long long key = make_key(hash, depth);
+	Entry& entry = entries[key & mask];
+
+	unsigned long long stored_count = entry.count.load(std::memory_order_relaxed);
+	if ((entry.key.load(std::memory_order_relaxed) ^ stored_count) != key) return false;
+
+	count = stored_count;
+	return true;
+}
+
+//always replaces whatever was there before
+void PerftTable::store(unsigned long long hash, int depth, unsigned long long count) {
+	unsigned long long key = make_key(hash, depth);
+	Entry& entry = entries[key & mask];
+
+	entry.key.store(key ^ count, std::memory_order_relaxed);
+	entry.count.store(count, std::memory_order_relaxed);
+}
+
+unsigned long long perft(Board* board, int depth, PerftTable* table) {
+	if (depth <= 0) return 1;
+
+	MoveList moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+
+	//every generated move is legal, so at the last ply the moves only need counting, not making
+	if (depth == 1) return moves.size();
+
+	unsigned long long nodes = 0;
+	if (table && table->probe(board->get_zobrist_hash(), depth, nodes)) return nodes;
+
+	for (const Move& m : moves) {
+		board->make_legal_move(m);
+		nodes += perft(board, depth - 1, table);
+		board->undo_move(m);
+	}
+
+	if (table) table->store(board->get_zobrist_hash(), depth, nodes);
+
+	return nodes;
+}
+
+unsigned long long perft_parallel(Board* board, int depth, int threads, PerftTable* table, unsigned long long* root_counts) {
+	if (depth <= 0) return 1;
+
+	MoveList moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+
+	//too small to be worth sharing out
+	if (depth <= 2 || threads <= 1) {
+		unsigned long long nodes = 0;
+		for (int i = 0; i < moves.size(); i++) {
+			board->make_legal_move(moves[i]);
+			unsigned long long move_nodes = perft(board, depth - 1, table);
+			board->undo_move(moves[i]);
+
+			if (root_counts) root_counts[i] = move_nodes;
+			nodes += move_nodes;
+		}
+		return nodes;
+	}
+
+	//each piece of work is a root move and one reply to it
+	//there are far more of these than root moves, so a thread which finishes early always has more to pick up
+	struct Work {
+		int root;
+		Move reply;
+	};
+
+	std::vector<Work> work;
+	for (int i = 0; i < moves.size(); i++) {
+		board->make_legal_move(moves[i]);
+		MoveList replies = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+		for (const Move& reply : replies) {
+			work.push_back({ i, reply });
+		}
+		board->undo_move(moves[i]);
+	}
+
+	std::vector<std::atomic<unsigned long long>> counts(moves.size());
+	for (auto& count : counts) count = 0;
+	std::atomic<int> next_work(0);
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&] {
+			//each thread makes moves on its own copy of the board
+			Board local = *board;
+			for (int i = next_work++; i < (int)work.size(); i = next_work++) {
+				const Move& root = moves[work[i].root];
+				local.make_legal_move(root);
+				local.make_legal_move(work[i].reply);
+				counts[work[i].root] += perft(&local, depth - 2, table);
+				local.undo_move(work[i].reply);
+				local.undo_move(root);
+			}
+		}));
+	}
+
+	for (auto& worker : workers) worker.join();
+
+	unsigned long long nodes = 0;
+	for (int i = 0; i < moves.size(); i++) {
+		if (root_counts) root_counts[i] = counts[i];
+		nodes += counts[i];
+	}
+
+	return nodes;
+}
+
+unsigned long long perft_divide(Board* board, int depth, int threads, int hash_megabytes) {
+	auto start = std::chrono::steady_clock::now();
+
+	std::unique_ptr<PerftTable> table;
+	if (hash_megabytes > 0) table = std::unique_ptr<PerftTable>(new PerftTable(hash_megabytes));
+
+	MoveList moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+	unsigned long long root_counts[MAX_MOVES];
+
+	unsigned long long nodes = 0;
+	if (depth > 0) {
+		nodes = perft_parallel(board, depth, threads, table.get(), root_counts);
+		for (int i = 0; i < moves.size(); i++) {
+			std::cout << create_lan_from_move(pack_move(moves[i])) << ": " << root_counts[i] << std::endl;
+		}
+	}
+
+	long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << std::endl << "Nodes searched: " << nodes << std::endl;
+	std::cout << "Threads: " << threads << std::endl;
+	std::cout << "Time: " << milliseconds << "ms" << std::endl;
+	std::cout << "Nodes per second: " << nodes * 1000 / std::max(milliseconds, 1LL) << std::endl << std::endl;
+
+	return nodes;
+}
+
+void perft_scaling(Board* board, int depth, int max_threads, int hash_megabytes) {
+	long long single_thread_milliseconds = 0;
+
+	for (int threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+		auto start = std::chrono::steady_clock::now();
+
+		//every run gets a fresh table, so later runs do not get the earlier ones' counts for free
+		std::unique_ptr<PerftTable> table;
+		if (hash_megabytes > 0) table = std::unique_ptr<PerftTable>(new PerftTable(hash_megabytes));
+
+		unsigned long long nodes = perft_parallel(board, depth, threads, table.get());
+
+		long long milliseconds = std::max((long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), 1LL);
+		if (threads == 1) single_thread_milliseconds = milliseconds;
+
+		std::cout << "Threads: " << threads << " Nodes: " << nodes << " Time: " << milliseconds << "ms"
+			<< " Nodes per second: " << nodes * 1000 / milliseconds
+			<< " Speedup: " << (double)single_thread_milliseconds / milliseconds << std::endl;
+
+		if (threads >= max_threads) break;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "board.h"
+
+//subtree counts shared between threads, so that positions reached by more than one move order are only counted once
+//each key is stored xored with its count, so an entry torn by two threads writing at once never matches and is just ignored
+class PerftTable {
+
+	struct Entry {
+		std::atomic<unsigned long long> key;
+		std::atomic<unsigned long long> count;
+	};
+
+	std::unique_ptr<Entry[]> entries;
+	unsigned long long mask;
+
+	//positions are only the same subtree if they are searched to the same depth, so the depth is mixed into the key
+	static unsigned long long make_key(unsigned long long hash, int depth) {
+		return hash ^ (depth * 0x9E3779B97F4A7C15ULL);
+	}
+
+public:
+	PerftTable(int);
+
+	bool probe(unsigned long long, int, unsigned long long&);
+	void store(unsigned long long, int, unsigned long long);
+};
+
+//counts every leaf of the legal move tree to a given depth
+//the counts for well known positions are published, so this checks move generation, make_move and undo_move, and times them
+unsigned long long perft(Board*, int, PerftTable* table = nullptr);
+
+//the same count, with the subtrees below the first two plies shared out between threads, each with its own copy of the board
+//if root_counts is given, the count below each root move (in get_legal_moves order) is written into it
+unsigned long long perft_parallel(Board*, int, int, PerftTable* table = nullptr, unsigned long long* root_counts = nullptr);
+
+//runs perft from the current position, printing the count below each root move, then the total and the speed
+//a hash_megabytes of 0 runs without a hash table
+unsigned long long perft_divide(Board*, int, int threads = 1, int hash_megabytes = 0);
+
+//runs the same perft with 1, 2, 4... up to max_threads threads, printing the speed of each and how it compares to one thread
+void perft_scaling(Board*, int, int, int hash_megabytes = 0);
\ No newline at end of file
@@ -3,6 +3,6 @@
 #include "move.h"
 
 struct SearchResult {
-	Move move;
-	double score;
+	PackedMove move;
+	int score;
 };
\ No newline at end of file
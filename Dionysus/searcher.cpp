@@ -1,5 +1,4 @@
 #include "searcher.h"
-#include "limits.h"
 #include "utils.h"
 
 #include <chrono>
@@ -8,347 +7,555 @@
 #include <random>
 #include <time.h>
 #include <iostream>
+#include <new>
 #include <iomanip>
+#include <cstdlib>
 
-Searcher::Searcher() {
-	trans_table.clear();
-	if (using_opening_book) init_opening_book();
+Searcher::Searcher(bool own_book, int hash_megabytes) : using_opening_book(own_book), trans_table(hash_megabytes) {
+	if (own_book && !book.open(BOOK_NAME)) {
+		std::cout << "Cant open file" << std::endl;
+	}
+
+	start_threads(1);
 }
 
-//used to sort moves before alpah beta pruning
-//captures are first, as these are more likely to be good, making ab pruning more effective
-bool compare_moves(Move a, Move b) {
-	bool a_capture = a.prev_square != EMPTY_SQUARE;
-	bool b_capture = b.prev_square != EMPTY_SQUARE;
+Searcher::~Searcher() {
+	stop_threads();
+}
 
-	if (!a_capture && !b_capture) {
-		return false;
+//the threads are created once here, rather than for every search, so starting a search only has to wake them
+void Searcher::start_threads(int count) {
+	for (int i = 0; i < count; i++) {
+		threads.push_back(std::make_unique<SearchThread>(this, i));
 	}
-	else if (a_capture && !b_capture) {
-		return true;
+}
+
+//stops any search in progress and ends every thread in the pool
+void Searcher::stop_threads() {
+	stop();
+	wait();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& thread : threads) thread->exit = true;
 	}
-	else if (!a_capture && b_capture) {
-		return false;
+	pool_condition.notify_all();
+
+	for (auto& thread : threads) thread->thread.join();
+	threads.clear();
+}
+
+void Searcher::wake(SearchThread& thread) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		thread.busy = true;
 	}
+	pool_condition.notify_all();
+}
 
-	return (a.prev_square % 6) > (b.prev_square % 6);
+void Searcher::wait_until_idle(SearchThread& thread) {
+	std::unique_lock<std::mutex> lock(mutex);
+	pool_condition.wait(lock, [&thread] { return !thread.busy; });
 }
 
-//load opening book moves into memory
-void Searcher::init_opening_book() {
-	FILE* book;
-	errno_t res = fopen_s(&book, BOOK_NAME, "r");
+void Searcher::wait() {
+	wait_until_idle(*threads[0]);
+}
 
-	//if opening the file failed
-	if (res != 0 || !book) {
-		std::cout << "Cant open file" << std::endl;
-		using_opening_book = false;
-		return;
-	}
+void Searcher::start_search(const SearchLimits& search_limits, const Board& board, std::function<void(PackedMove, PackedMove)> callback) {
+	wait();
+
+	root = board;
+	limits = search_limits;
+	on_finished = callback;
+	searching = true;
+	pondering = limits.ponder;
+	search_start = std::chrono::steady_clock::now();
+
+	//the clock starts as soon as we are told to go, or when the ponder move is played
+	time_manager.init(limits, root.is_white_to_move() ? WHITE : BLACK, move_overhead);
 
-	//find out how many entries there are
-	long num_entries;
-	fseek(book, 0, SEEK_END);
-	num_entries = ftell(book) / sizeof(BookEntry);
-	rewind(book);
+	wake(*threads[0]);
+}
 
-	entries = (BookEntry*)malloc(sizeof(BookEntry) * num_entries);
+//the opponent played the move we were pondering on, so the search carries on as normal, with the clock starting now
+//the clock is reset before pondering is cleared, as the search threads only look at it once they see pondering is false
+void Searcher::ponderhit() {
+	time_manager.init(limits, root.is_white_to_move() ? WHITE : BLACK, move_overhead);
 
-	if (!entries) {
-		std::cout << "Something went wrong" << std::endl;
-		using_opening_book = false;
-		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pondering = false;
 	}
+	pool_condition.notify_all();
+}
 
-	//actually read the data
-	int result = fread(entries, sizeof(BookEntry), num_entries, book);
+//a stored result is only reused if its move does not walk into a draw by the 50 move rule or repetition, which the stored score may not know about
+//another thread may be writing the entry as we read it, so its move is checked before being made
+bool avoids_draw(PackedMove pm, Board* board) {
+	if (pm == NULL_MOVE) return true;
 
-	using_opening_book = num_entries > 0;
-	book_size = num_entries;
+	Move m = board->unpack_move(pm);
+	if (pack_move(m) != pm || !board->is_legal(m)) return false;
+
+	board->make_legal_move(m);
+	bool draw = board->get_half_move_clock() >= 100 || board->is_three_move_rep();
+	board->undo_move(m);
+
+	return !draw;
 }
 
 //quiescence is run at each terminal node in negamax, to stabilise the position
 //means we do not stop search halfway through a queen trade, and think we are a queen up/down
-double Searcher::quiescence(double alpha, double beta, Board *board) {
+Searcher::SearchThread::SearchThread(Searcher* searcher, int id) : searcher(searcher), id(id) {
+	thread = std::thread(&SearchThread::idle_loop, this);
+}
+
+//waits to be woken, runs the search, then goes back to sleep
+//the main thread runs the whole search, the others just their own iterative deepening
+void Searcher::SearchThread::idle_loop() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(searcher->mutex);
+			searcher->pool_condition.wait(lock, [this] { return busy || exit; });
+			if (exit) return;
+		}
+
+		if (id == 0) {
+			PackedMove move = searcher->get_best_move(&searcher->root);
+			searcher->on_finished(move, searcher->get_ponder_move(&searcher->root, move));
+		}
+		else {
+			iterative_deepening();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(searcher->mutex);
+			busy = false;
+		}
+		searcher->pool_condition.notify_all();
+	}
+}
+
+//start a new search from board, forgetting everything from the last one
+void Searcher::SearchThread::reset(const Board& root) {
+	board = root;
+	best = { NULL_MOVE, 0 };
+	best_pv_length = 0;
+	completed_depth = 0;
+	nodes = 0;
+	for (int i = 0; i < MAX_PLY; i++) {
+		killers[i][0] = NULL_MOVE;
+		killers[i][1] = NULL_MOVE;
+	}
+}
+
+//searches one ply deeper each iteration, until the search is stopped or a forced mate is found
+//odd numbered helper threads go up two plies at a time, so they spend most of their time a ply ahead of the others, filling the table with deeper results
+//the root is never cut off by the table (see negamax), so their deeper root entries only order the main thread's moves rather than standing in for its iterations
+void Searcher::SearchThread::iterative_deepening() {
+	int depth = 0;
+	int step = id % 2 == 1 ? 2 : 1;
+
+	while (searcher->searching && std::abs(best.score) < MATE_BOUND && depth + step <= MAX_PLY) {
+		depth += step;
+		seldepth = 0;
+		SearchResult tmp = negamax(depth, 0, -INFINITE_SCORE, INFINITE_SCORE, &board, best.move);
+
+		//if search at this depth concluded
+		if (searcher->searching) {
+			best = tmp;
+			completed_depth = depth;
+
+			//the root is always searched rather than taken from the table, so its line always starts with the best move
+			best_pv_length = pv_length[0];
+			for (int i = 0; i < best_pv_length; i++) best_pv[i] = pv[0][i];
+			extend_pv(depth);
+
+			if (id == 0) {
+				report_iteration(depth);
+
+				//no point starting another iteration which is deeper than we were asked for, or which is unlikely to finish in time
+				//time doesnt count while pondering
+				bool out_of_time = !searcher->pondering && searcher->time_manager.past_soft_limit();
+				if ((searcher->limits.depth > 0 && depth >= searcher->limits.depth) || out_of_time) break;
+			}
+		}
+	}
+}
+
+//only this thread writes its count, so it doesnt need an atomic increment, just a store the other threads can read
+//every CHECK_INTERVAL nodes, each thread checks whether the search has run out of time or nodes, so a search always stops within a few thousand nodes of its limit
+void Searcher::SearchThread::count_node() {
+	unsigned long long count = nodes.load(std::memory_order_relaxed) + 1;
+	nodes.store(count, std::memory_order_relaxed);
+
+	if (count % CHECK_INTERVAL == 0 && searcher->searching) {
+		bool out_of_time = !searcher->pondering && searcher->time_manager.past_hard_limit();
+		bool out_of_nodes = searcher->limits.nodes > 0 && searcher->nodes_searched() >= searcher->limits.nodes;
+		if (out_of_time || out_of_nodes) searcher->stop();
+	}
+}
+
+//info depth <depth> seldepth <ply> score <score> nodes <n> nps <n> hashfull <permille> time <ms> pv <moves>
+//the nodes and speed are for every thread together, the rest is this thread's
+void Searcher::SearchThread::report_iteration(int depth) {
+	unsigned long long nodes = searcher->nodes_searched();
+	int elapsed = searcher->search_time();
+
+	std::cout << "info depth " << depth << " seldepth " << seldepth << " score " << create_uci_score(best.score)
+		<< " nodes " << nodes << " nps " << nodes * 1000 / std::max(elapsed, 1) << " hashfull " << searcher->trans_table.hashfull()
+		<< " time " << elapsed << " pv";
+	for (int i = 0; i < best_pv_length; i++) std::cout << " " << create_lan_from_move(best_pv[i]);
+	std::cout << std::endl;
+}
+
+int Searcher::SearchThread::quiescence(int alpha, int beta, int ply, Board *board) {
+	count_node();
+	seldepth = std::max(seldepth, ply);
 
 	//current eval
-	double standing_pat = (board->is_white_to_move() ? 1 : -1) * board->evaluate_position();
+	int standing_pat = (board->is_white_to_move() ? 1 : -1) * board->evaluate_position();
 
 	alpha = std::max(alpha, standing_pat);
 
 	if (alpha >= beta) return beta;
 
-	//get all captures and sort them by what they are capturing (higher value targets first)
-	std::vector<Move> valid_moves = board->get_valid_captures(board->is_white_to_move() ? WHITE : BLACK);
-	std::sort(valid_moves.begin(), valid_moves.end(), compare_moves);
-
-	//iterate through each capture, as in negamax
-	for (const Move &m : valid_moves) {
-		if (board->make_move(m)) {
-			double score = -quiescence(-beta, -alpha, board);
-			board->undo_move(m);
-			alpha = std::max(alpha, score);
-			if (alpha >= beta) return beta;
-		}
+	//try each legal capture, higher value targets first
+	MovePicker picker(board);
+	Move m;
+	while (picker.next(m)) {
+		board->make_legal_move(m);
+		int score = -quiescence(-beta, -alpha, ply + 1, board);
+		board->undo_move(m);
+		alpha = std::max(alpha, score);
+		if (alpha >= beta) return beta;
 	}
 
 	//return best score seen
 	return alpha;
 }
 
-SearchResult Searcher::negamax(int depth, double alpha, double beta, Board *board, Move first) {
+SearchResult Searcher::SearchThread::negamax(int depth, int ply, int alpha, int beta, Board *board, PackedMove first) {
+
+	//the line from here is empty until a move is found
+	pv_length[ply] = ply;
 
 	//cancel search is necessary
-	if (!searching) return { };
+	if (!searcher->searching) return { };
+	count_node();
+	seldepth = std::max(seldepth, ply);
 
-	double alphaOrig = alpha;
+	int alphaOrig = alpha;
 	
 	
 	//check to see if this position has already been calculated to this depth or further
-	TransTableEntry* trans_entry = trans_table.get_if_exists(board->get_zobrist_hash());
-	if (trans_entry->flag != NOT_PRESENT && trans_entry->depth >= depth) {
-
-		//if we have the exact score, we can just return this
-		if (trans_entry->flag == EXACT) {
-			board->make_move(trans_entry->sr.move);
-			if (board->get_half_move_clock() < 100 && !board->is_three_move_rep()) {
-				board->undo_move(trans_entry->sr.move);
-				return trans_entry->sr;
+	//never at the root, the table outlives each search (and helper threads run ahead), so a stored root result would answer a whole iteration with no line
+	//there the entry only gives the move to try first
+	TransTableEntry trans_entry = searcher->trans_table.get_if_exists(board->get_zobrist_hash());
+	if (ply > 0 && trans_entry.flag != NOT_PRESENT && trans_entry.depth >= depth) {
+		SearchResult stored = { trans_entry.move, score_from_tt(trans_entry.score, ply) };
+
+		//the stored result was searched this deep, even if not by this thread
+		seldepth = std::max(seldepth, ply + trans_entry.depth);
+
+		//if we have the exact score, we can just return this, with the stored move as the line from here
+		if (trans_entry.flag == EXACT) {
+			if (avoids_draw(stored.move, board)) {
+				if (stored.move != NULL_MOVE) {
+					pv[ply][ply] = stored.move;
+					pv_length[ply] = ply + 1;
+				}
+				return stored;
 			}
-			board->undo_move(trans_entry->sr.move);
 		}
 		//if we only have a lower bound, we can update alpha using this
-		else if (trans_entry->flag == LOWER_BOUND) {
-			alpha = std::max(alpha, trans_entry->sr.score);
+		else if (trans_entry.flag == LOWER_BOUND) {
+			alpha = std::max(alpha, stored.score);
 		}
 		//likewise with beta
-		else if (trans_entry->flag == UPPER_BOUND) {
-			beta = std::min(beta, trans_entry->sr.score);
+		else if (trans_entry.flag == UPPER_BOUND) {
+			beta = std::min(beta, stored.score);
 		}
 
 		//normal ab pruning
 		if (alpha >= beta) {
-			board->make_move(trans_entry->sr.move);
-			if (board->get_half_move_clock() < 100 && !board->is_three_move_rep()) {
-				board->undo_move(trans_entry->sr.move);
-				return trans_entry->sr;
-			}
-			board->undo_move(trans_entry->sr.move);
+			if (avoids_draw(stored.move, board)) return stored;
 		}
 	}
 
-	//initial best move seen
-	SearchResult value = { {0,0,0,0,0} , (double)INT_MIN - depth - 10 };
+	//initial best move seen, worse than any real score
+	SearchResult value = { NULL_MOVE, -INFINITE_SCORE };
 
-	//get all valid moves and sort by captures, increasing ab pruning effectiveness as it is more likely that successful moves are tried earlier
-	std::vector<Move> valid_moves = board->get_valid_moves(board->is_white_to_move() ? WHITE : BLACK);
-	std::sort(valid_moves.begin(), valid_moves.end(), compare_moves);
+	//try the moves most likely to be good first, increasing ab pruning effectiveness
+	//if we have been told to search a specific move first, it takes the place of the transposition table's move
+	PackedMove tt_move = first;
+	if (tt_move == NULL_MOVE && trans_entry.flag != NOT_PRESENT) tt_move = trans_entry.move;
 
-	//if we have been told to search a specific move first, put this at the front
-	//ab pruning means we do not need to remove it from the rest of the list, as it will barely be searched again
-	if (first.player != -1) valid_moves.insert(valid_moves.begin(), first);
+	MovePicker picker(board, tt_move, killers[ply]);
+	int move_count = 0;
+	Move m;
 
-	//iterate through each move
-	for (const Move &m : valid_moves) {
-		if (board->make_move(m)) {
-			SearchResult sr;
+	//iterate through each move, all of which are legal
+	while (picker.next(m)) {
+		move_count++;
 
-			//if 50 move rule is up or we have three folded, then this is a draw
-			if (board->get_half_move_clock() >= 100 || board->is_three_move_rep()) {
-				sr =  { m, 0 };
-			}
-			//if this is the final move of the search, get the score of the position via quiescence
-			else if (depth <= 1) {
-				sr = { m, -quiescence(-beta, -alpha, board) };
-			}
-			//if we have more to go, get the score using negamax
-			else {
-				sr = negamax(depth - 1, -beta, -alpha, board);
-				sr.score *= -1;
-			}
+		//long iterations report which root move they are on, so the gui can show the search is still going
+		if (ply == 0 && id == 0 && searcher->search_time() >= CURRMOVE_MIN_TIME) {
+			std::cout << "info depth " << depth << " currmove " << create_lan_from_move(pack_move(m)) << " currmovenumber " << move_count << std::endl;
+		}
 
-			//if new best, update value
-			if (sr.score > value.score) {
-				value = { m, sr.score };
-			}
-			
-			//undo the move
-			board->undo_move(m);
+		board->make_legal_move(m);
+		SearchResult sr;
 
-			//ab pruning
-			alpha = std::max(alpha, value.score);
-			if (alpha >= beta) break;
+		//a draw or quiescence score has no line after the move, negamax fills in its own
+		pv_length[ply + 1] = ply + 1;
+
+		//if 50 move rule is up or we have three folded, then this is a draw
+		if (board->get_half_move_clock() >= 100 || board->is_three_move_rep()) {
+			sr = { pack_move(m), DRAW_SCORE };
+		}
+		//if this is the final move of the search, get the score of the position via quiescence
+		else if (depth <= 1) {
+			sr = { pack_move(m), -quiescence(-beta, -alpha, ply + 1, board) };
+		}
+		//if we have more to go, get the score using negamax
+		else {
+			sr = negamax(depth - 1, ply + 1, -beta, -alpha, board);
+			sr.score *= -1;
+		}
+
+		//if new best, update value
+		if (sr.score > value.score) {
+			value = { pack_move(m), sr.score };
+			update_pv(ply, value.move);
+		}
+		
+		//undo the move
+		board->undo_move(m);
+
+		//ab pruning
+		alpha = std::max(alpha, value.score);
+		if (alpha >= beta) {
+			update_killers(ply, m);
+			break;
 		}
 	}
 
-	//if no possible moves
-	if (value.score <= (double)INT_MIN - depth - 10) {
-		//if stalemate
-		if (!board->in_check(board->is_white_to_move() ? WHITE : BLACK)) {
-			value.score = 0;
+	//if no possible moves, either checkmate (scored by how far from the root it is, so quicker mates are preferred) or stalemate
+	if (move_count == 0) {
+		if (board->in_check(board->is_white_to_move() ? WHITE : BLACK)) {
+			value.score = -MATE_SCORE + ply;
+		}
+		else {
+			value.score = DRAW_SCORE;
 		}
-		//otherwise in checkmate, can leave score as is
 	}
 
-	//store this result in the transposition table for the future
-	//if we are still looking and if the move is not still the default from above
-	if (searching && value.score > (double)INT_MIN - depth - 10) {
-		TransTableEntry new_trans_entry = { EXACT, value, depth };
+	//store this result in the transposition table for the future, if we are still looking
+	if (searcher->searching) {
+		TransTableEntry new_trans_entry = { EXACT, (unsigned char)depth, value.move, score_to_tt(value.score, ply), 0, 0 };
 		if (value.score <= alphaOrig) {
 			new_trans_entry.flag = UPPER_BOUND;
 		}
 		else if (value.score >= beta) {
 			new_trans_entry.flag = LOWER_BOUND;
 		}
-		trans_table.store(board->get_zobrist_hash(), new_trans_entry);
+		searcher->trans_table.store(board->get_zobrist_hash(), new_trans_entry);
 	}
 
 	return value;
 }
 
-//stops the search after milliseconds
-//only if we are still doing the same search - could be onto the next one if for example the other search was stopped early to play a book move
-void Searcher::stop_searching(int milliseconds, int SID) {
-	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
-	if (SID == searchID) stop();
+//a line which runs into a stored result stops there, so it is carried on with the table's exact moves, up to the depth of the iteration
+//another thread may be writing an entry as we read it, so each move is checked before being made
+void Searcher::SearchThread::extend_pv(int depth) {
+	Board line = board;
+	for (int i = 0; i < best_pv_length; i++) line.make_legal_move(line.unpack_move(best_pv[i]));
+
+	while (best_pv_length < depth) {
+		TransTableEntry entry = searcher->trans_table.get_if_exists(line.get_zobrist_hash());
+		if (entry.flag != EXACT || entry.move == NULL_MOVE) break;
+
+		Move m = line.unpack_move(entry.move);
+		if (pack_move(m) != entry.move || !line.is_legal(m)) break;
+		line.make_legal_move(m);
+		best_pv[best_pv_length++] = entry.move;
+	}
+}
+
+//a quiet move which caused a cut off is likely to do so again in other positions at the same ply
+void Searcher::SearchThread::update_killers(int ply, const Move& m) {
+	bool capture = m.prev_square != EMPTY_SQUARE || (m.start_type == PAWN && (m.end - m.start) % 8 != 0);
+	if (capture) return;
+
+	PackedMove pm = pack_move(m);
+	if (killers[ply][0] != pm) {
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = pm;
+	}
+}
+
+//the best line from ply is the move followed by the best line from the position after it
+void Searcher::SearchThread::update_pv(int ply, PackedMove m) {
+	pv[ply][ply] = m;
+	for (int i = ply + 1; i < pv_length[ply + 1]; i++) pv[ply][i] = pv[ply + 1][i];
+	pv_length[ply] = std::max(pv_length[ply + 1], ply + 1);
 }
 
+//taking the lock means a main thread waiting for the end of an infinite or ponder search cant miss the notification
 void Searcher::stop() {
-	searching = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		searching = false;
+	}
+	pool_condition.notify_all();
 }
 
-//uses iterative deepening negamax until milliseconds is up to find the best move in the position
-Move Searcher::get_best_move(int milliseconds, Board *board) {
-	searching = true;
+unsigned long long Searcher::nodes_searched() {
+	unsigned long long total = 0;
+	for (auto& thread : threads) total += thread->nodes.load(std::memory_order_relaxed);
+	return total;
+}
 
-	//starts timer
-	searchID++;
-	std::thread stop_search([this, milliseconds] { stop_searching(milliseconds, searchID); });
-
-	//check for a book move
-	//have to swap the endianness of all the fields in each entry, since they are stored in the binary field as big endian
-	if (using_opening_book) {
-		std::vector<BookEntry*> matches;
-		int total_weight = 0;
-		//collect all the entries together which fit the current position
-		for (int i = 0; i < book_size; i++) {
-			if (board->get_zobrist_hash() == endian_swap_u64(entries[i].key)) {
-				matches.push_back(&entries[i]);
-				entries[i].weight = endian_swap_u16(entries[i].weight);
-				total_weight += entries[i].weight;
-			}
-		}
-		//if we found any entries for this position
-		//choose a random one based on the weighting of each entry
-		if (total_weight > 0) {
-			std::random_device rd; // obtain a random number from hardware
-			std::mt19937 gen(rd()); // seed the generator
-			std::uniform_int_distribution<> distr(0, total_weight); // define the range
-			int r = distr(gen); // generate a random integer
-			int cum_weight = 0;
-			for (const auto entry : matches) {
-				cum_weight += entry->weight;
-				//return the formatted move which we land on
-				if (cum_weight >= r) {
-					Move m = decipher_polyglot_move_code(endian_swap_u16(entry->move), board);
-					std::cout << "Using book move" << std::endl;
-					stop_search.detach();
-					return m;
-				}
-			}
-		}
+//only called between searches
+void Searcher::set_move_overhead(int milliseconds) {
+	move_overhead = milliseconds;
+}
+
+//only called between searches
+void Searcher::set_threads(int count) {
+	if (count == (int)threads.size()) return;
+	stop_threads();
+	start_threads(count);
+}
+
+//only called between searches, as the search uses the table without any locking
+//asking for more memory than the machine has shouldnt kill the engine, so the old table is kept instead
+void Searcher::set_hash_size(int megabytes) {
+	try {
+		trans_table.resize(megabytes);
 	}
+	catch (const std::bad_alloc&) {
+		std::cout << "info string error cant allocate " << megabytes << " MB for the hash table, keeping the old one" << std::endl;
+	}
+}
 
+void Searcher::clear_hash() {
 	trans_table.clear();
+}
 
-	int depth = 0;
-	SearchResult sr = { {-1}, 0 };
+//nothing from the last game is any use in the next one
+void Searcher::new_game() {
+	trans_table.clear();
+}
 
-	//stop if we searching is false or we see a guaranteed checkmate for either side
-	while (searching && sr.score > (double)INT_MIN && sr.score < INT_MAX) {
-		depth++;
-		SearchResult tmp = negamax(depth, (double)INT_MIN, INT_MAX, board, sr.move);
+void Searcher::set_own_book(bool enabled) {
+	using_opening_book = enabled;
+}
 
-		//if search at this depth concluded
-		if (searching) {
-			sr = tmp;
-			std::cout << std::fixed << "Depth " << depth << " move " << create_lan_from_move(sr.move) << " score " << sr.score << std::endl;
-		}
+//if the new book cant be opened there is no book at all, rather than quietly carrying on with the old one
+void Searcher::set_book_file(const std::string& path) {
+	if (!book.open(path)) {
+		std::cout << "Cant open file " << path << std::endl;
 	}
+}
+
+//check for a book move, NULL_MOVE if there isnt one
+//the book can be any file the gui names, so this relies on probe only ever returning moves which are legal here
+PackedMove Searcher::get_book_move(Board *board) {
+	if (!using_opening_book || !book.is_open()) return NULL_MOVE;
 
-	stop_search.detach();
-	return sr.move;
+	PackedMove m = book.probe(board);
+	if (m != NULL_MOVE) std::cout << "info string using book move" << std::endl;
+	return m;
 }
 
-//generate all possible moves, and pick a random one
-Move Searcher::get_random_move(Board *board) {
-	std::vector<Move> valid_moves = board->get_valid_moves(board->is_white_to_move() ? WHITE : BLACK);
-	auto rng = std::default_random_engine(time(NULL));
-	std::shuffle(valid_moves.begin(), valid_moves.end(), rng);
+//run by the main search thread, uses iterative deepening negamax on every thread until time is up to find the best move in the position
+PackedMove Searcher::get_best_move(Board *board) {
+	//each thread searches its own copy of the board
+	//they are reset even when the move comes from the book, so the last search's line is never taken for this position's
+	for (auto& thread : threads) thread->reset(*board);
+
+	PackedMove book_move = get_book_move(board);
+	if (book_move == NULL_MOVE) {
+		//the table is kept from the last search, as it has usually already seen this position a couple of plies deeper
+		trans_table.new_search();
 
-	//keep going until we get a move that doesnt leave our king in check
-	//GUI should check for stale/checkmate for us so we dont need to worry about running out of moves
-	int i = 0;
-	while (i < valid_moves.size() && !board->make_move(valid_moves[i])) {
-		i++;
+		for (size_t i = 1; i < threads.size(); i++) wake(*threads[i]);
+
+		//the main thread decides when the search is over, when time is up, a limit from the go command is reached or it has found a forced mate
+		threads[0]->iterative_deepening();
 	}
 
-	return valid_moves[i];
-}
-
-Move Searcher::decipher_polyglot_move_code(unsigned short code, Board *board) {
-
-	//extract eahc piece of information from bit field
-	int dst_file = (code >> 0) & 7;
-	int dst_row = (code >> 3) & 7;
-	int src_file = (code >> 6) & 7;
-	int src_row = (code >> 9) & 7;
-	int prom_pc = (code >> 12) & 7;
-
-	//convert row/file to the index in board's representation
-	int src_code = (7 - src_row) * 8 + src_file;
-	int dst_code = (7 - dst_row) * 8 + dst_file;
-
-	int prev_square = board->get_square(dst_code);
-
-	//determine the start and end piece types
-	int starting_piece = board->get_square(src_code) % 6;
-	int end_piece = starting_piece;
-	switch (prom_pc) {
-	case 0:
-		break;
-	case 1:
-		end_piece = KNIGHT;
-		break;
-	case 2:
-		end_piece = BISHOP;
-		break;
-	case 3:
-		end_piece = ROOK;
-		break;
-	case 4:
-		end_piece = QUEEN;
-		break;
+	//go infinite has to keep going until it is told to stop, and go ponder until it is stopped or the ponder move is played
+	//even if there is nothing left to search, as the gui is not expecting a move yet
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		pool_condition.wait(lock, [this] { return !searching || (!limits.infinite && !pondering); });
 	}
+	searching = false;
+	for (size_t i = 1; i < threads.size(); i++) wait_until_idle(*threads[i]);
 
-	int player = board->is_white_to_move() ? WHITE : BLACK;
+	if (book_move != NULL_MOVE) return book_move;
 
-	//if castle, need to change target square to just 2 squares along instead of on the rook
-	if (starting_piece == KING) {
-		std::vector<std::pair<int, int>> castle_moves = { std::make_pair(4, 7), std::make_pair(4, 0), std::make_pair(60, 63), std::make_pair(60, 56) };
+	PackedMove best_move = best_thread()->best.move;
+	if (best_move != NULL_MOVE) return best_move;
 
-		for (int i = 0; i < 4; i++) {
-			if (src_code == castle_moves[i].first && dst_code == castle_moves[i].second) {
-				prev_square = EMPTY_SQUARE;
-				dst_code = src_code + (dst_code > src_code ? 2 : -2);
-				break;
-			}
-		}
+	//stopped before even depth 1 finished, the gui still needs a legal move, so use the table's move for the position, or failing that any legal move
+	best_move = trans_table.get_if_exists(board->get_zobrist_hash()).move;
+	if (best_move != NULL_MOVE) {
+		Move m = board->unpack_move(best_move);
+		if (pack_move(m) == best_move && board->is_legal(m)) return best_move;
 	}
 
-	//return the extracted move
-	Move m = { player, src_code, dst_code, starting_piece, end_piece, prev_square };
-	return m;
+	MoveList legal_moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+	return legal_moves.empty() ? NULL_MOVE : pack_move(legal_moves[0]);
+}
 
-	
+//milliseconds since the search started, including any time spent pondering
+int Searcher::search_time() {
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_start).count();
+}
+
+//use the main thread's result, unless a helper finished a deeper iteration
+Searcher::SearchThread* Searcher::best_thread() {
+	SearchThread* best = threads[0].get();
+	for (auto& thread : threads) {
+		if (thread->completed_depth > best->completed_depth) best = thread.get();
+	}
+	return best;
+}
+
+//the reply we expect to move, which is what the gui will ask us to ponder on
+//this is the second move of the principal variation, or if that is too short (or move came from the book), the best move stored for the position after move
+//NULL_MOVE if there isnt a legal one
+PackedMove Searcher::get_ponder_move(Board *board, PackedMove move) {
+	if (move == NULL_MOVE) return NULL_MOVE;
+
+	//move has to be checked before it is made, as it may have come from the book rather than the search
+	Move m = board->unpack_move(move);
+	if (pack_move(m) != move || !board->is_legal(m)) return NULL_MOVE;
+	board->make_legal_move(m);
+
+	//the reply is checked the same way whichever it came from
+	SearchThread* best = best_thread();
+	PackedMove reply = best->best_pv_length > 1 && best->best_pv[0] == move ? best->best_pv[1] : trans_table.get_if_exists(board->get_zobrist_hash()).move;
+	if (reply != NULL_MOVE) {
+		Move r = board->unpack_move(reply);
+		if (pack_move(r) != reply || !board->is_legal(r)) reply = NULL_MOVE;
+	}
+
+	board->undo_move(m);
+	return reply;
+}
+
+//generate all legal moves, and pick a random one
+//GUI should check for stale/checkmate for us so we dont need to worry about running out of moves
+PackedMove Searcher::get_random_move(Board *board) {
+	MoveList valid_moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+	auto rng = std::default_random_engine(time(NULL));
+	std::shuffle(valid_moves.begin(), valid_moves.end(), rng);
+
+	return pack_move(valid_moves[0]);
 }
\ No newline at end of file
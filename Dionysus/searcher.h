@@ -1,37 +1,138 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "transposition_table.h"
+#include "opening_book.h"
+#include "time_manager.h"
 #include "board.h"
+#include "move_picker.h"
+
+//most search threads the Threads option allows
+#define MAX_THREADS 256
+
+//how many nodes each thread searches between checks of the time and node limits
+#define CHECK_INTERVAL 1024
+
+//how long (in ms) the search has to have been running before the move being searched at the root is reported
+#define CURRMOVE_MIN_TIME 3000
 
 class Searcher {
 
-	struct BookEntry {
-		unsigned long long key;
-		unsigned short move;
-		unsigned short weight;
-		unsigned int learn;
+	//everything a single search thread needs to itself
+	//all the threads share the searcher's transposition table, and only learn from each other through it (lazy smp)
+	//each one is a persistent thread, which sleeps between searches until it is woken for the next one
+	struct SearchThread {
+		Searcher* searcher;
+		int id;
+		Board board;
+
+		//two quiet moves per ply which recently caused a beta cut off, to try early in sibling nodes
+		PackedMove killers[MAX_PLY][2];
+
+		//triangular principal variation table, pv[ply] is the best line found from ply onwards, running up to pv_length[ply]
+		PackedMove pv[MAX_PLY + 1][MAX_PLY + 1];
+		int pv_length[MAX_PLY + 1];
+
+		//deepest ply reached in the current iteration, including the quiescence search
+		int seldepth = 0;
+
+		//result of the deepest iteration this thread has finished
+		SearchResult best = { NULL_MOVE, 0 };
+		PackedMove best_pv[MAX_PLY];
+		int best_pv_length = 0;
+		int completed_depth = 0;
+
+		//only ever written by this thread, but read by the others to check the node limit
+		std::atomic<unsigned long long> nodes{ 0 };
+
+		//busy is set to wake the thread for a search, and cleared by the thread once it has finished
+		//exit is set to end the thread, both are guarded by the searcher's mutex
+		bool busy = false;
+		bool exit = false;
+		std::thread thread;
+
+		SearchThread(Searcher*, int);
+
+		void idle_loop();
+		void reset(const Board&);
+		void iterative_deepening();
+		int quiescence(int, int, int, Board*);
+		SearchResult negamax(int, int, int, int, Board*, PackedMove first = NULL_MOVE);
+		void update_killers(int, const Move&);
+		void update_pv(int, PackedMove);
+		void extend_pv(int);
+		void count_node();
+		void report_iteration(int);
 	};
 
-	BookEntry* entries = nullptr;
-	int book_size = 0;
-	bool searching = false;
+	std::atomic<bool> searching{ false };
+	std::atomic<bool> pondering{ false };
 	bool using_opening_book = true;
-	int searchID = 0;
+	OpeningBook book;
 	TranspositionTable trans_table;
 
-	void init_opening_book();
-	double quiescence(double, double, Board*);
-	SearchResult negamax(int, double, double, Board*, Move first = { -1 });
-	void stop_searching(int, int);
-	Move decipher_polyglot_move_code(unsigned short code, Board* board);
+	//the pool of search threads, created once and reused for every search, threads[0] is the main thread which runs the search
+	std::vector<std::unique_ptr<SearchThread>> threads;
+	std::mutex mutex;
+	std::condition_variable pool_condition;
+
+	//the search the main thread has been woken for
+	Board root;
+	SearchLimits limits;
+	TimeManager time_manager;
+	int move_overhead = DEFAULT_MOVE_OVERHEAD;
+	std::function<void(PackedMove, PackedMove)> on_finished;
+
+	//when go was received, for the time in info lines
+	//unlike the time manager's clock, this is never reset by ponderhit, so the search threads can read it at any time
+	std::chrono::steady_clock::time_point search_start;
+
+	void start_threads(int);
+	void stop_threads();
+	void wake(SearchThread&);
+	void wait_until_idle(SearchThread&);
+	PackedMove get_book_move(Board*);
+	PackedMove get_best_move(Board*);
+	PackedMove get_ponder_move(Board*, PackedMove);
+	SearchThread* best_thread();
+	int search_time();
 
 public:
-	Searcher();
+	//own_book opens and uses the default book, a searcher with it off never touches the book unless it is turned on later
+	//the table is allocated at the given size straight away, rather than at the default size and then resized
+	Searcher(bool own_book = true, int hash_megabytes = DEFAULT_HASH_MEGABYTES);
+	~Searcher();
 
-	Move get_best_move(int, Board*);
-	Move get_random_move(Board*);
+	//searches the position on the thread pool within the limits from the go command, and returns straight away
+	//on_finished is called with the best move and the reply we expect (or NULL_MOVE) from the main search thread once the search is over
+	void start_search(const SearchLimits&, const Board&, std::function<void(PackedMove, PackedMove)>);
+	void ponderhit();
+
+	//blocks until the current search (if there is one) has finished
+	void wait();
+
+	PackedMove get_random_move(Board*);
 
 	void stop();
 
+	//nodes searched by every thread so far in the current search, or in the last one once it has finished
+	unsigned long long nodes_searched();
+
+	void set_threads(int);
+	void set_move_overhead(int);
+	void set_hash_size(int);
+	void clear_hash();
+	void new_game();
+	void set_own_book(bool);
+	void set_book_file(const std::string&);
+
 };
 
@@ -0,0 +1,56 @@
+#include "time_manager.h"
+#include "defs.h"
+
+#include <algorithm>
+
+void TimeManager::init(const SearchLimits& limits, int player, int move_overhead) {
+	start = std::chrono::steady_clock::now();
+	soft_limit = 0;
+	hard_limit = 0;
+
+	//go infinite only ends on stop, whatever clocks come with it
+	if (limits.infinite) return;
+
+	//a fixed time per move uses all of it
+	if (limits.move_time > 0) {
+		soft_limit = hard_limit = std::max(limits.move_time - move_overhead, 1);
+	}
+	//otherwise share out what is left on the clock between the moves still to play, plus most of the increment
+	//the hard limit lets a move run on to a few times its share, if an iteration is nearly done, but never uses more than 80% of the clock
+	else if (limits.time[player] > 0) {
+		int remaining = std::max(limits.time[player] - move_overhead, 1);
+		int moves_to_go = limits.moves_to_go > 0 ? std::min(limits.moves_to_go, DEFAULT_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+		int share = remaining / moves_to_go + limits.increment[player] * 3 / 4;
+		hard_limit = std::max(std::min(share * 3, remaining * 4 / 5), 1);
+		soft_limit = std::min(share, hard_limit);
+	}
+	//a clock was given, but only the opponent's, so there is nothing to share out, but the gui still expects a timed search
+	else if (limits.time[WHITE] > 0 || limits.time[BLACK] > 0) {
+		soft_limit = hard_limit = std::max(DEFAULT_MOVE_TIME - move_overhead, 1);
+	}
+}
+
+bool TimeManager::has_deadline() const {
+	return hard_limit > 0;
+}
+
+int TimeManager::elapsed() const {
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+int TimeManager::get_soft_limit() const {
+	return soft_limit;
+}
+
+int TimeManager::get_hard_limit() const {
+	return hard_limit;
+}
+
+bool TimeManager::past_soft_limit() const {
+	return soft_limit > 0 && elapsed() >= soft_limit;
+}
+
+bool TimeManager::past_hard_limit() const {
+	return hard_limit > 0 && elapsed() >= hard_limit;
+}
\ No newline at end of file
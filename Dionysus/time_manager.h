@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+//used when the go command gives no limits at all
+#define DEFAULT_MOVE_TIME 5000
+
+//time lost between us sending a move and the gui stopping our clock, taken off every allocation
+#define DEFAULT_MOVE_OVERHEAD 10
+#define MAX_MOVE_OVERHEAD 5000
+
+//with no movestogo, plan as if this many moves are left in the game
+#define DEFAULT_MOVES_TO_GO 30
+
+//everything a go command can limit the search by, with 0 meaning no limit
+struct SearchLimits {
+	int time[2] = { 0, 0 }; //milliseconds left on each player's clock, indexed by WHITE/BLACK
+	int increment[2] = { 0, 0 };
+	int moves_to_go = 0;
+	int move_time = 0;
+	int depth = 0;
+	unsigned long long nodes = 0;
+	bool infinite = false;
+	bool ponder = false; //searching on the opponent's time, the limits only apply once the move we are pondering on is played
+};
+
+//decides how long to spend on a move, with two limits
+//the soft limit is checked between iterations: once it has passed, starting another iteration is unlikely to finish, so we stop
+//the hard limit stops the search wherever it has got to, so that we never run too far over
+class TimeManager {
+
+	std::chrono::steady_clock::time_point start;
+	int soft_limit = 0;
+	int hard_limit = 0;
+
+public:
+	//works out the limits for player's move from the go command, and starts the clock
+	void init(const SearchLimits&, int, int);
+
+	//whether there is a time limit at all, e.g. not for go infinite or go depth n
+	bool has_deadline() const;
+
+	int elapsed() const;
+	int get_soft_limit() const;
+	int get_hard_limit() const;
+	bool past_soft_limit() const;
+	bool past_hard_limit() const;
+};
\ No newline at end of file
@@ -1,28 +1,191 @@
 #include "transposition_table.h"
 
-//dont need a real hash function, as the zobrist hashes are already hashed. Just mod by max value of size_t to get them down to correct size
-size_t hash_function(unsigned long long key) {
-	return key % ((size_t)-1);
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <malloc.h>
+#endif
+
+//transparent huge pages on linux are 2MB, and are only used for memory aligned to them
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+//how many plies of depth one search's worth of age is traded against when choosing which entry to replace
+#define AGE_DEPTH_PENALTY 8
+
+//below this it is quicker to clear the table on the calling thread than to start any others
+#define PARALLEL_CLEAR_BYTES (16 * 1024 * 1024)
+
+TranspositionTable::TranspositionTable(int megabytes) {
+	resize(megabytes);
 }
 
-TranspositionTable::TranspositionTable() {
-	trans_table = tt_internal_map_type(1000000, hash_function);
+TranspositionTable::~TranspositionTable() {
+	free_buckets();
 }
 
-TransTableEntry* TranspositionTable::get_if_exists(unsigned long long zobrist_hash) {
-	auto it = trans_table.find(zobrist_hash);
-	if (it == trans_table.end()) {
-		return &not_present;
-	}
-	else {
-		return &(it->second);
+void TranspositionTable::free_buckets() {
+#ifdef _MSC_VER
+	_aligned_free(buckets);
+#else
+	std::free(buckets);
+#endif
+	buckets = nullptr;
+}
+
+void TranspositionTable::resize(int megabytes) {
+	megabytes = std::max(megabytes, MIN_HASH_MEGABYTES);
+
+	//as many buckets as fit in the memory given, the bucket is then picked by scaling the hash down to that count (see bucket_for)
+	unsigned long long count = (unsigned long long)megabytes * 1024 * 1024 / sizeof(TransTableBucket);
+	size_t bytes = count * sizeof(TransTableBucket);
+
+	//tables of at least a huge page are aligned to one, and the allocation is rounded up to a whole number of them as aligned_alloc needs
+	size_t alignment = bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(TransTableBucket);
+	size_t allocated = (bytes + alignment - 1) / alignment * alignment;
+
+	//the new table is allocated before the old one is freed, so if there isnt the memory the old table is left as it was
+#ifdef _MSC_VER
+	TransTableBucket* allocation = (TransTableBucket*)_aligned_malloc(allocated, alignment);
+#else
+	TransTableBucket* allocation = (TransTableBucket*)std::aligned_alloc(alignment, allocated);
+#endif
+	if (!allocation) throw std::bad_alloc();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	//only a hint, if huge pages are turned off the table still works on normal pages
+	madvise(allocation, allocated, MADV_HUGEPAGE);
+#endif
+
+	free_buckets();
+	buckets = allocation;
+	bucket_count = count;
+	clear();
+}
+
+//data word layout: flag in bits 0-7, depth 8-15, move 16-31, score 32-47 and generation 48-55
+unsigned long long pack_entry(const TransTableEntry& entry) {
+	return (unsigned long long)(unsigned char)entry.flag
+		| (unsigned long long)entry.depth << 8
+		| (unsigned long long)entry.move << 16
+		| (unsigned long long)(unsigned short)entry.score << 32
+		| (unsigned long long)entry.generation << 48;
+}
+
+TransTableEntry unpack_entry(unsigned long long data, unsigned long long key) {
+	return { (signed char)(data & 0xFF), (unsigned char)(data >> 8), (PackedMove)(data >> 16), (short)(data >> 32), (unsigned char)(data >> 48), key };
+}
+
+//the high half of hash * bucket_count, which spreads the hashes evenly over any number of buckets, not just a power of two
+TransTableBucket& TranspositionTable::bucket_for(unsigned long long zobrist_hash) {
+#ifdef _MSC_VER
+	return buckets[__umulh(zobrist_hash, bucket_count)];
+#else
+	return buckets[(unsigned long long)(((unsigned __int128)zobrist_hash * bucket_count) >> 64)];
+#endif
+}
+
+TransTableEntry TranspositionTable::get_if_exists(unsigned long long zobrist_hash) {
+	TransTableBucket& bucket = bucket_for(zobrist_hash);
+	for (TransTableSlot& slot : bucket.slots) {
+		unsigned long long data = slot.data.load(std::memory_order_relaxed);
+		if ((slot.key.load(std::memory_order_relaxed) ^ data) == zobrist_hash && (data & 0xFF) != NOT_PRESENT) {
+			return unpack_entry(data, zobrist_hash);
+		}
 	}
+
+	return { NOT_PRESENT, 0, NULL_MOVE, 0, 0, 0 };
+}
+
+void TranspositionTable::new_search() {
+	generation++;
 }
 
+//an existing entry for the same position is always overwritten, otherwise the new entry goes in an empty slot if there is one
+//if the bucket is full, the least valuable entry is replaced: deeper (more expensive) results are worth more, older ones less
 void TranspositionTable::store(unsigned long long zobrist_hash, TransTableEntry entry) {
-	trans_table[zobrist_hash] = entry;
+	TransTableBucket& bucket = bucket_for(zobrist_hash);
+
+	//the generation wraps around, so the age is also taken mod 256
+	auto worth = [this](const TransTableEntry& current) {
+		return current.depth - AGE_DEPTH_PENALTY * (unsigned char)(generation - current.generation);
+	};
+
+	TransTableSlot* replace = nullptr;
+	TransTableEntry replaced = {};
+	for (TransTableSlot& slot : bucket.slots) {
+		unsigned long long data = slot.data.load(std::memory_order_relaxed);
+		TransTableEntry current = unpack_entry(data, slot.key.load(std::memory_order_relaxed) ^ data);
+
+		if (current.flag == NOT_PRESENT || current.key == zobrist_hash) {
+			replace = &slot;
+			replaced = current;
+			break;
+		}
+		if (!replace || worth(current) < worth(replaced)) {
+			replace = &slot;
+			replaced = current;
+		}
+	}
+
+	//a result with no move (e.g. no moves at all) should not lose the move we already knew about
+	if (entry.move == NULL_MOVE && replaced.key == zobrist_hash) entry.move = replaced.move;
+
+	entry.generation = generation;
+	unsigned long long data = pack_entry(entry);
+	replace->key.store(zobrist_hash ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+//entries left from earlier searches dont count, as they are the first to be replaced
+//the buckets are picked by the high bits of random hashes, so the first few are as good a sample as any
+int TranspositionTable::hashfull() {
+	unsigned long long sampled = std::min((unsigned long long)HASHFULL_SAMPLE_BUCKETS, bucket_count);
+	unsigned long long used = 0;
+	for (unsigned long long i = 0; i < sampled; i++) {
+		for (TransTableSlot& slot : buckets[i].slots) {
+			unsigned long long data = slot.data.load(std::memory_order_relaxed);
+			if ((data & 0xFF) != NOT_PRESENT && (unsigned char)(data >> 48) == generation) used++;
+		}
+	}
+
+	return (int)(used * 1000 / (sampled * 4));
+}
+
+//the slots are atomics, so they are zeroed one store at a time rather than memset underneath them
+void TranspositionTable::clear_buckets(unsigned long long start, unsigned long long end) {
+	for (unsigned long long i = start; i < end; i++) {
+		for (TransTableSlot& slot : buckets[i].slots) {
+			slot.key.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
 }
 
 void TranspositionTable::clear() {
-	trans_table.clear();
+	size_t bytes = bucket_count * sizeof(TransTableBucket);
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+	if (bytes < PARALLEL_CLEAR_BYTES || threads == 1) {
+		clear_buckets(0, bucket_count);
+		return;
+	}
+
+	//each thread zeroes its own contiguous slice, which on a fresh table is also the first touch of those pages
+	unsigned long long slice = (bucket_count + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < threads; i++) {
+		unsigned long long start = std::min(i * slice, bucket_count);
+		unsigned long long end = std::min(start + slice, bucket_count);
+		workers.emplace_back([this, start, end] { clear_buckets(start, end); });
+	}
+	for (std::thread& worker : workers) worker.join();
 }
\ No newline at end of file
@@ -1,32 +1,99 @@
 #pragma once
 
-#include <unordered_map>
-#include <functional>
+#include <atomic>
 
 #include "search_result.h"
 
-#define NOT_PRESENT -1
-#define EXACT 0
-#define LOWER_BOUND 1
-#define UPPER_BOUND 2
+//memory given to the table when no size is asked for, and the range allowed by the Hash option
+#define DEFAULT_HASH_MEGABYTES 64
+#define MIN_HASH_MEGABYTES 1
+#define MAX_HASH_MEGABYTES 65536
 
+//buckets sampled to estimate how full the table is
+#define HASHFULL_SAMPLE_BUCKETS 250
+
+//empty slots are all zero, so a freshly cleared table reads as NOT_PRESENT everywhere
+#define NOT_PRESENT 0
+#define EXACT 1
+#define LOWER_BOUND 2
+#define UPPER_BOUND 3
+
+//scores are stored in 16 bits, with mate scores counted from the stored position rather than the root (see score_to_tt)
+//the full zobrist hash is kept, as only its high bits pick the bucket
+//generation is the search which stored the entry, so entries left over from earlier moves can be replaced first
 struct TransTableEntry {
-	int flag;
-	SearchResult sr;
-	int depth;
+	signed char flag;
+	unsigned char depth;
+	PackedMove move;
+	short score;
+	unsigned char generation;
+	unsigned long long key;
+};
+
+//how an entry is actually held in the table, so that every thread can read and write it at once without locking
+//everything but the key is packed into one word, and the key is stored xored with it
+//if two threads write the same slot together and the words get mixed up, the key no longer matches and the entry is just ignored
+struct TransTableSlot {
+	std::atomic<unsigned long long> key;
+	std::atomic<unsigned long long> data;
 };
 
-typedef std::unordered_map<unsigned long long, TransTableEntry, std::function<size_t(unsigned long long key)>> tt_internal_map_type;
+//four entries share one 64 byte bucket, aligned so that a probe only ever touches one cache line
+struct alignas(64) TransTableBucket {
+	TransTableSlot slots[4];
+};
+
+static_assert(sizeof(TransTableBucket) == 64, "a transposition table bucket should fill exactly one cache line");
+
+//a mate score is relative to the root, but the same position can be reached at a different ply in another search
+//so store mates as distance from the position itself, and convert back when they are read
+inline short score_to_tt(int score, int ply) {
+	if (score >= MATE_BOUND) return score + ply;
+	if (score <= -MATE_BOUND) return score - ply;
+	return score;
+}
+
+inline int score_from_tt(short score, int ply) {
+	if (score >= MATE_BOUND) return score - ply;
+	if (score <= -MATE_BOUND) return score + ply;
+	return score;
+}
 
+//fixed size, open addressed table of buckets, allocated once up front so it never allocates during search
+//shared by every search thread without any locking (see TransTableSlot)
+//the memory is backed by huge pages where the os supports it, as a large table otherwise misses the tlb on almost every probe
 class TranspositionTable {
 
-	tt_internal_map_type trans_table;
-	TransTableEntry not_present = { NOT_PRESENT };
+	TransTableBucket* buckets = nullptr;
+	unsigned long long bucket_count = 0;
+	unsigned char generation = 0;
+
+	TransTableBucket& bucket_for(unsigned long long);
+	void clear_buckets(unsigned long long, unsigned long long);
+	void free_buckets();
 
 public:
-	TranspositionTable();
-	TransTableEntry* get_if_exists(unsigned long long);
+	TranspositionTable(int megabytes = DEFAULT_HASH_MEGABYTES);
+	~TranspositionTable();
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	//throws away every entry and reallocates the table to fill the given memory
+	//throws std::bad_alloc if there isnt enough, in which case the old table is kept as it was
+	void resize(int megabytes);
+
+	//a copy of the entry for this hash, with a flag of NOT_PRESENT if there isnt one
+	TransTableEntry get_if_exists(unsigned long long);
 	void store(unsigned long long, TransTableEntry);
+
+	//called at the start of each search, entries from earlier searches are kept but are the first to be replaced
+	void new_search();
+
+	//zeroes the table, split between every core so that even a table of several gigabytes is cleared quickly
 	void clear();
+
+	//roughly how much of the table the current search has filled, in permille, for the uci hashfull field
+	int hashfull();
 };
 
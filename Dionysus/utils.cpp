@@ -1,27 +1,82 @@
 #include "utils.h"
 #include <iostream>
 
-Move create_move_from_lan(std::string lan, Board* board) {
-	int player = board->is_white_to_move() ? WHITE : BLACK;
-
+//the board is not needed, as LAN only gives the squares and the promotion piece
+//use Board::unpack_move to get the full move
+PackedMove create_move_from_lan(std::string lan) {
 	int start_pos = get_square_index_from_notation(lan.substr(0, 2));
 	int end_pos = get_square_index_from_notation(lan.substr(2, 2));
+	int promotion = lan.size() == 4 ? PAWN : get_piece_from_char(lan[4]);
+
+	return pack_move(start_pos, end_pos, promotion);
+}
+
+//SAN only gives the piece type and where it lands, plus just enough of the start square to tell pieces apart
+//so the board is needed to find which legal move is meant, NULL_MOVE if none of them match
+PackedMove create_move_from_san(std::string san, Board* board) {
+	//check, mate and annotation marks make no difference to the move
+	while (!san.empty() && std::string("+#!?").find(san.back()) != std::string::npos) san.pop_back();
+
+	MoveList moves = board->get_legal_moves(board->is_white_to_move() ? WHITE : BLACK);
+
+	//castling is the king moving two squares
+	if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+		int direction = san.size() == 3 ? 2 : -2;
+		for (const Move& m : moves) {
+			if (m.start_type == KING && m.end - m.start == direction) return pack_move(m);
+		}
+		return NULL_MOVE;
+	}
+
+	//promotions are written e8=Q, or sometimes e8Q
+	int promotion = PAWN;
+	if (san.size() > 2 && std::string("NBRQ").find(san.back()) != std::string::npos) {
+		promotion = get_piece_from_char(std::tolower(san.back()));
+		san.pop_back();
+		if (san.back() == '=') san.pop_back();
+	}
+
+	int type = PAWN;
+	if (!san.empty() && std::string("NBRQK").find(san[0]) != std::string::npos) {
+		type = get_piece_from_char(std::tolower(san[0]));
+		san = san.substr(1);
+	}
+
+	if (san.size() < 2) return NULL_MOVE;
+	char file = san[san.size() - 2], rank = san[san.size() - 1];
+	if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return NULL_MOVE;
+	int end = get_square_index_from_notation(san.substr(san.size() - 2));
 
-	std::vector<int> squares = board->get_squares();
+	//anything left between the piece and the target square is the start file and/or rank, and the capture mark
+	std::string from = san.substr(0, san.size() - 2);
 
-	int start_type = squares[start_pos] % 6;
-	int end_type = lan.size() == 4 ? start_type : get_piece_from_char(lan[4]);
+	for (const Move& m : moves) {
+		if (m.start_type != type || m.end != end || m.end_type != (promotion == PAWN ? type : promotion)) continue;
 
-	int prev_square = squares[end_pos];
-	return { player, start_pos, end_pos, start_type, end_type, prev_square };
+		bool matches = true;
+		for (char c : from) {
+			if (c >= 'a' && c <= 'h' && m.start % 8 != c - 'a') matches = false;
+			if (c >= '1' && c <= '8' && m.start / 8 != 7 - (c - '1')) matches = false;
+		}
+		if (matches) return pack_move(m);
+	}
+
+	return NULL_MOVE;
 }
 
-std::string create_lan_from_move(Move m) {
-	std::string lan = get_notation_from_square_index(m.start) + get_notation_from_square_index(m.end);
-	if (m.start_type != m.end_type) lan += std::tolower(get_char_from_piece(m.end_type));
+std::string create_lan_from_move(PackedMove m) {
+	std::string lan = get_notation_from_square_index(packed_start(m)) + get_notation_from_square_index(packed_end(m));
+	if (packed_promotion(m) != PAWN) lan += std::tolower(get_char_from_piece(packed_promotion(m)));
 	return lan;
 }
 
+//"cp <centipawns>", or "mate <moves>" if there is a forced mate, with a negative number of moves if we are the one getting mated
+std::string create_uci_score(int score) {
+	if (score >= MATE_BOUND) return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+	if (score <= -MATE_BOUND) return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+	return "cp " + std::to_string(score);
+}
+
 int get_square_index_from_notation(std::string notation) {
 	int c = notation[0] - 'a';
 	int r = 7 - (notation[1] - '1');
@@ -3,8 +3,10 @@
 #include "Move.h"
 #include "Board.h"
 
-Move create_move_from_lan(std::string, Board*);
-std::string create_lan_from_move(Move);
+PackedMove create_move_from_lan(std::string);
+PackedMove create_move_from_san(std::string, Board*);
+std::string create_lan_from_move(PackedMove);
+std::string create_uci_score(int);
 
 int get_square_index_from_notation(std::string);
 std::string get_notation_from_square_index(int);
@@ -0,0 +1,12 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/bench.h"
+#include "../Dionysus/bench.cpp"
+#include "../Dionysus/searcher.cpp"
+
+//the node count is only any use as a signature if the same search always gives the same count
+TEST(Bench, NodeCountIsTheSameEveryRun) {
+	unsigned long long nodes = bench(3);
+	EXPECT_GT(nodes, 0);
+	EXPECT_EQ(bench(3), nodes);
+}
\ No newline at end of file
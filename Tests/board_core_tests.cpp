@@ -2,9 +2,8 @@
 #include "gtest/gtest.h"
 #include "../Dionysus/board.h"
 #include "../Dionysus/board_core.cpp"
+#include "../Dionysus/bitboards.cpp"
 #include "../Dionysus/utils.cpp"
-#include "../Dionysus/transposition_table.h"
-#include "../Dionysus/transposition_table.cpp"
 
 TEST(BoardInitialisation, SquaresInitialiseFromStartingPos) {
 	Board b;
@@ -57,16 +56,10 @@ TEST(BoardInitialisation, WhiteToMoveInitialiseFromStartingPos) {
 
 TEST(BoardInitialisation, CastleRightsInitialiseFromStartingPos) {
 	Board b;
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-
-	ASSERT_EQ(can_castle.size(), 2);
-	ASSERT_EQ(can_castle[WHITE].size(), 2);
-	ASSERT_EQ(can_castle[BLACK].size(), 2);
-
-	EXPECT_EQ(can_castle[WHITE][LEFT], true);
-	EXPECT_EQ(can_castle[WHITE][RIGHT], true);
-	EXPECT_EQ(can_castle[BLACK][LEFT], true);
-	EXPECT_EQ(can_castle[BLACK][RIGHT], true);
+	EXPECT_EQ(b.has_castling_right(WHITE, LEFT), true);
+	EXPECT_EQ(b.has_castling_right(WHITE, RIGHT), true);
+	EXPECT_EQ(b.has_castling_right(BLACK, LEFT), true);
+	EXPECT_EQ(b.has_castling_right(BLACK, RIGHT), true);
 }
 
 TEST(BoardInitialisation, HalfMoveClockInitialiseFromStartingPos) {
@@ -137,16 +130,10 @@ TEST(BoardInitialisation, WhiteToMoveInitialiseFromRandomPos) {
 
 TEST(BoardInitialisation, CastleRightsInitialiseFromRandomPos) {
 	Board b("3k2nr/p3pp1p/7b/p3N3/Q2P1PpP/P3P3/1r4P1/RN2K2R b KQ h3 0 1");
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-
-	ASSERT_EQ(can_castle.size(), 2);
-	ASSERT_EQ(can_castle[WHITE].size(), 2);
-	ASSERT_EQ(can_castle[BLACK].size(), 2);
-
-	EXPECT_EQ(can_castle[WHITE][LEFT], true);
-	EXPECT_EQ(can_castle[WHITE][RIGHT], true);
-	EXPECT_EQ(can_castle[BLACK][LEFT], false);
-	EXPECT_EQ(can_castle[BLACK][RIGHT], false);
+	EXPECT_EQ(b.has_castling_right(WHITE, LEFT), true);
+	EXPECT_EQ(b.has_castling_right(WHITE, RIGHT), true);
+	EXPECT_EQ(b.has_castling_right(BLACK, LEFT), false);
+	EXPECT_EQ(b.has_castling_right(BLACK, RIGHT), false);
 }
 
 TEST(BoardInitialisation, HalfMoveClockInitialiseFromRandomPos) {
@@ -192,20 +179,20 @@ TEST(BoardMakeMove, PawnPushKeepsClockAtZero) {
 TEST(BoardMakeMove, PawnPushRetainsCastlingRights) {
 	Board b;
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 
 	Move e4 = { WHITE, 52, 36, PAWN, PAWN, EMPTY_SQUARE };
 	b.make_move(e4);
 
 	can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, PawnPushCreatesEnPassantTarget) {
@@ -244,7 +231,7 @@ TEST(BoardMakeMove, PawnPushIsUndoneCorrectly) {
 	Board b;
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -255,12 +242,7 @@ TEST(BoardMakeMove, PawnPushIsUndoneCorrectly) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -272,7 +254,7 @@ TEST(BoardMakeMove, MultipleMovesAreUndoneCorrectly) {
 	Board b;
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -289,12 +271,7 @@ TEST(BoardMakeMove, MultipleMovesAreUndoneCorrectly) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -306,7 +283,7 @@ TEST(BoardMakeMove, PawnCaptureIsUndoneCorrectly) {
 	Board b("rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 1");
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -317,12 +294,7 @@ TEST(BoardMakeMove, PawnCaptureIsUndoneCorrectly) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -336,11 +308,11 @@ TEST(BoardMakeMove, KingMoveRemovesCastlingRights) {
 	Move ke2 = { WHITE, 60, 52, KING, KING, EMPTY_SQUARE };
 	b.make_move(ke2);
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_FALSE(can_castle[0][0]);
-	EXPECT_FALSE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_FALSE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_FALSE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, UndoingKingMoveRestoresCastlingRights) {
@@ -350,11 +322,11 @@ TEST(BoardMakeMove, UndoingKingMoveRestoresCastlingRights) {
 	b.make_move(ke2);
 	b.undo_move(ke2);
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, RightRookMoveRemovesCastlingRights) {
@@ -363,11 +335,11 @@ TEST(BoardMakeMove, RightRookMoveRemovesCastlingRights) {
 	Move rh8 = { BLACK, 7, 15, ROOK, ROOK, EMPTY_SQUARE };
 	b.make_move(rh8);
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_FALSE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_FALSE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, LeftRookMoveRemovesCastlingRights) {
@@ -376,11 +348,11 @@ TEST(BoardMakeMove, LeftRookMoveRemovesCastlingRights) {
 	Move rh1 = { BLACK, 0, 8, ROOK, ROOK, EMPTY_SQUARE };
 	b.make_move(rh1);
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_FALSE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_FALSE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, UndoingRookMoveRestoresCastlingRights) {
@@ -390,11 +362,11 @@ TEST(BoardMakeMove, UndoingRookMoveRestoresCastlingRights) {
 	b.make_move(rh8);
 	b.undo_move(rh8);
 
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
-	EXPECT_TRUE(can_castle[0][0]);
-	EXPECT_TRUE(can_castle[0][1]);
-	EXPECT_TRUE(can_castle[1][0]);
-	EXPECT_TRUE(can_castle[1][1]);
+	int can_castle = b.get_castling_rights();
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(0, 1));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 0));
+	EXPECT_TRUE(can_castle & CASTLING_RIGHT(1, 1));
 }
 
 TEST(BoardMakeMove, PawnPromotionWorks) {
@@ -414,7 +386,7 @@ TEST(BoardMakeMove, PawnPromotionCanBeUndone) {
 	Board b("8/P7/8/8/8/8/8/8 w - - 0 1");
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -425,12 +397,7 @@ TEST(BoardMakeMove, PawnPromotionCanBeUndone) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -502,7 +469,7 @@ TEST(BoardMakeMove, EnPassantCanBeUndone) {
 	Board b("8/8/8/3pP3/8/8/8/8 w - e4 0 1");
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -513,12 +480,7 @@ TEST(BoardMakeMove, EnPassantCanBeUndone) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -557,7 +519,7 @@ TEST(BoardMakeMove, CastlingCanBeUndone) {
 	Board b("r3k3/8/8/8/8/8/8/8 w q - 0 1");
 
 	int en_passant_target = b.get_en_passant_target();
-	std::vector<std::vector<bool>> can_castle = b.get_castling_rights();
+	int can_castle = b.get_castling_rights();
 	int half_move_clock = b.get_half_move_clock();
 	std::vector<int> squares = b.get_squares();
 
@@ -568,12 +530,7 @@ TEST(BoardMakeMove, CastlingCanBeUndone) {
 	EXPECT_EQ(en_passant_target, b.get_en_passant_target());
 	EXPECT_EQ(half_move_clock, b.get_half_move_clock());
 
-	std::vector<std::vector<bool>> new_can_castle = b.get_castling_rights();
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			EXPECT_EQ(can_castle[i][j], new_can_castle[i][j]);
-		}
-	}
+	EXPECT_EQ(can_castle, b.get_castling_rights());
 
 	std::vector<int> new_squares = b.get_squares();
 	for (int i = 0; i < 64; i++) {
@@ -593,4 +550,95 @@ TEST(BoardMakeMove, CannotCastleThroughk) {
 
 	Move O_O_O = { BLACK, 4, 2, KING, KING, EMPTY_SQUARE };
 	EXPECT_FALSE(b.make_move(O_O_O));
+}
+
+TEST(BoardPackedMove, UnpackRecoversCapture) {
+	Board b("rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 1");
+
+	Move exd5 = { WHITE, 36, 27, PAWN, PAWN, BLACK * 6 + PAWN };
+	Move m = b.unpack_move(pack_move(exd5));
+
+	EXPECT_EQ(m.player, exd5.player);
+	EXPECT_EQ(m.start, exd5.start);
+	EXPECT_EQ(m.end, exd5.end);
+	EXPECT_EQ(m.start_type, exd5.start_type);
+	EXPECT_EQ(m.end_type, exd5.end_type);
+	EXPECT_EQ(m.prev_square, exd5.prev_square);
+}
+
+TEST(BoardPackedMove, PromotionSurvivesLanRoundTrip) {
+	Board b("8/P6k/8/8/8/8/8/K7 w - - 0 1");
+
+	PackedMove pm = create_move_from_lan("a7a8n");
+	EXPECT_EQ(create_lan_from_move(pm), "a7a8n");
+
+	Move m = b.unpack_move(pm);
+	EXPECT_EQ(m.start_type, PAWN);
+	EXPECT_EQ(m.end_type, KNIGHT);
+	EXPECT_EQ(m.prev_square, EMPTY_SQUARE);
+}
+
+TEST(BoardZobristHash, MatchesPublishedPolyglotKeys) {
+	//the example keys from the polyglot book format, en passant only counts when the capture is possible
+	std::vector<std::pair<std::vector<std::string>, unsigned long long>> games = {
+		{ {}, 0x463b96181691fc9cULL },
+		{ { "e2e4" }, 0x823c9b50fd114196ULL },
+		{ { "e2e4", "d7d5" }, 0x0756b94461c50fb0ULL },
+		{ { "e2e4", "d7d5", "e4e5" }, 0x662fafb965db29d4ULL },
+		{ { "e2e4", "d7d5", "e4e5", "f7f5" }, 0x22a48b5a8e47ff78ULL },
+		{ { "e2e4", "d7d5", "e4e5", "f7f5", "e1e2" }, 0x652a607ca3f242c1ULL },
+		{ { "e2e4", "d7d5", "e4e5", "f7f5", "e1e2", "e8f7" }, 0x00fdd303c946bdd9ULL },
+		{ { "a2a4", "b7b5", "h2h4", "b5b4", "c2c4" }, 0x3c8123ea7b067637ULL },
+		{ { "a2a4", "b7b5", "h2h4", "b5b4", "c2c4", "b4c3", "a1a3" }, 0x5c3f9b829b279560ULL },
+	};
+
+	for (const auto& game : games) {
+		Board b;
+		for (const std::string& lan : game.first) b.make_move(b.unpack_move(create_move_from_lan(lan)));
+		EXPECT_EQ(b.get_zobrist_hash(), game.second);
+	}
+}
+
+TEST(BoardStaticExchange, DefendedPawnCostsTheKnight) {
+	Board b("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1");
+
+	Move nxe5 = { WHITE, 43, 28, KNIGHT, KNIGHT, BLACK * 6 + PAWN };
+	EXPECT_EQ(b.see(nxe5), 100 - 310);
+}
+
+TEST(BoardStaticExchange, UndefendedPawnIsWon) {
+	Board b("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+
+	Move rxe5 = { WHITE, 60, 28, ROOK, ROOK, BLACK * 6 + PAWN };
+	EXPECT_EQ(b.see(rxe5), 100);
+}
+
+TEST(BoardEvaluation, IncrementalEvaluationMatchesFreshBoard) {
+	Board b("r3k3/1P6/8/8/8/8/8/R3K2R w KQq - 0 1");
+	int start_eval = b.evaluate_position();
+
+	//capture with promotion, king move, then castling
+	Move bxa8_q = { WHITE, 9, 0, PAWN, QUEEN, BLACK * 6 + ROOK };
+	Move ke7 = { BLACK, 4, 12, KING, KING, EMPTY_SQUARE };
+	Move O_O = { WHITE, 60, 62, KING, KING, EMPTY_SQUARE };
+
+	b.make_move(bxa8_q);
+	EXPECT_EQ(b.evaluate_position(), Board("Q3k3/8/8/8/8/8/8/R3K2R b KQ - 0 1").evaluate_position());
+	b.make_move(ke7);
+	b.make_move(O_O);
+	EXPECT_EQ(b.evaluate_position(), Board("Q7/4k3/8/8/8/8/8/R4RK1 b - - 2 2").evaluate_position());
+
+	b.undo_move(O_O);
+	b.undo_move(ke7);
+	b.undo_move(bxa8_q);
+	EXPECT_EQ(b.evaluate_position(), start_eval);
+}
+
+TEST(BoardEvaluation, EnPassantUpdatesEvaluation) {
+	Board b("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+
+	Move exd6 = { WHITE, 28, 19, PAWN, PAWN, EMPTY_SQUARE };
+	b.make_move(exd6);
+
+	EXPECT_EQ(b.evaluate_position(), Board("4k3/8/3P4/8/8/8/8/4K3 b - - 0 1").evaluate_position());
 }
\ No newline at end of file
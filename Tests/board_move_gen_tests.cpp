@@ -5,7 +5,9 @@
 
 
 //assumes we have already checked that the correct number of moves have been returned
-bool expected_moves_are_seen(std::map<int, std::vector<int>> expected_moves, std::vector<Move> moves) {
+//works with both a MoveList straight from the board and a std::vector of filtered moves
+template <typename T>
+bool expected_moves_are_seen(std::map<int, std::vector<int>> expected_moves, const T& moves) {
 
 	//removes each move from expected_moves when we find it in moves
 	for (int i = 0; i < moves.size(); i++) {
@@ -28,7 +30,7 @@ bool expected_moves_are_seen(std::map<int, std::vector<int>> expected_moves, std
 
 TEST(BoardMoveGeneration, WhiteMovesFromStartPos) {
 	Board b;
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	ASSERT_EQ(moves.size(), 20);
 
@@ -51,7 +53,7 @@ TEST(BoardMoveGeneration, WhiteMovesFromStartPos) {
 
 TEST(BoardMoveGeneration, BlackMovesFromStartPos) {
 	Board b;
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 
 	ASSERT_EQ(moves.size(), 20);
 
@@ -74,7 +76,7 @@ TEST(BoardMoveGeneration, BlackMovesFromStartPos) {
 
 TEST(BoardMoveGeneration, PawnCanPromoteStraight) {
 	Board b("8/3P4/8/8/8/8/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	ASSERT_EQ(moves.size(), 4);
 
@@ -101,7 +103,7 @@ TEST(BoardMoveGeneration, PawnCanPromoteStraight) {
 
 TEST(BoardMoveGeneration, PawnCanPromoteByCapturing) {
 	Board b("8/8/8/8/8/8/3p4/3BR3 b - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 
 	ASSERT_EQ(moves.size(), 4);
 
@@ -128,7 +130,7 @@ TEST(BoardMoveGeneration, PawnCanPromoteByCapturing) {
 
 TEST(BoardMoveGeneration, PawnCanMoveTwoOnFirstGo) {
 	Board b("8/8/8/8/8/8/2P5/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	ASSERT_EQ(moves.size(), 2);
 
@@ -146,7 +148,7 @@ TEST(BoardMoveGeneration, PawnCanMoveTwoOnFirstGo) {
 
 TEST(BoardMoveGeneration, PawnCantMoveTwoOnRankThree) {
 	Board b("8/8/8/8/8/2P5/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	ASSERT_EQ(moves.size(), 1);
 
@@ -164,7 +166,7 @@ TEST(BoardMoveGeneration, PawnCantMoveTwoOnRankThree) {
 
 TEST(BoardMoveGeneration, PawnCantMoveStraightThroughPiece) {
 	Board b("8/8/8/8/2R1b3/2P1P3/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 	std::vector<Move> pawn_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(pawn_moves), [](Move m) { return m.start_type == PAWN; });
 
@@ -175,7 +177,7 @@ TEST(BoardMoveGeneration, PawnCantMoveStraightThroughPiece) {
 
 TEST(BoardMoveGeneration, PawnCanCaptureDiagonally) {
 	Board b("8/p3p2p/RQ1rrrQR/8/8/8/8/8 b - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 	std::vector<Move> pawn_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(pawn_moves), [](Move m) { return m.start_type == PAWN; });
 	ASSERT_EQ(pawn_moves.size(), 2);
@@ -194,7 +196,7 @@ TEST(BoardMoveGeneration, PawnCanCaptureDiagonally) {
 
 TEST(BoardMoveGeneration, KnightMovesCorrectlyInCentre) {
 	Board b("8/8/7P/4r3/6N1/8/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 	std::vector<Move> knight_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(knight_moves), [](Move m) { return m.start_type == KNIGHT; });
 	ASSERT_EQ(knight_moves.size(), 5);
@@ -222,7 +224,7 @@ TEST(BoardMoveGeneration, KnightMovesCorrectlyInCentre) {
 
 TEST(BoardMoveGeneration, BishopMovesCorrectlyInCentre) {
 	Board b("5n2/6b1/8/8/8/2R5/8/8 b - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 	std::vector<Move> bishop_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(bishop_moves), [](Move m) { return m.start_type == BISHOP; });
 	ASSERT_EQ(bishop_moves.size(), 6);
@@ -250,7 +252,7 @@ TEST(BoardMoveGeneration, BishopMovesCorrectlyInCentre) {
 
 TEST(BoardMoveGeneration, RookMovesCorrectlyInCentre) {
 	Board b("2B5/8/2r2P2/2b5/8/8/8/8 b - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 	std::vector<Move> rook_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(rook_moves), [](Move m) { return m.start_type == ROOK; });
 	ASSERT_EQ(rook_moves.size(), 7);
@@ -278,7 +280,7 @@ TEST(BoardMoveGeneration, RookMovesCorrectlyInCentre) {
 
 TEST(BoardMoveGeneration, QueenMovesCorrectlyInCentre) {
 	Board b("8/2N5/4qq2/4Q3/8/2R1b1P1/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 	std::vector<Move> queen_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(queen_moves), [](Move m) { return m.start_type == QUEEN; });
 	ASSERT_EQ(queen_moves.size(), 14);
@@ -306,7 +308,7 @@ TEST(BoardMoveGeneration, QueenMovesCorrectlyInCentre) {
 
 TEST(BoardMoveGeneration, KingMovesCorrectlyInCentre) {
 	Board b("8/8/2n5/3KP3/3P4/8/8/8 w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 	std::vector<Move> king_moves;
 	std::copy_if(moves.begin(), moves.end(), std::back_inserter(king_moves), [](Move m) { return m.start_type == KING; });
 	ASSERT_EQ(king_moves.size(), 6);
@@ -334,7 +336,7 @@ TEST(BoardMoveGeneration, KingMovesCorrectlyInCentre) {
 
 TEST(BoardMoveGeneration, EnPassantIsFound) {
 	Board b("8/8/8/3pP3/8/8/8/8 b - e4 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 	ASSERT_EQ(moves.size(), 2);
 
 	//check one move is diagonal to square e4
@@ -348,7 +350,7 @@ TEST(BoardMoveGeneration, EnPassantIsFound) {
 
 TEST(BoardMoveGeneration, EnPassantIsNotFoundWhenNotThere) {
 	Board b("8/8/8/3pP3/8/8/8/8 b - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(BLACK);
+	MoveList moves = b.get_valid_moves(BLACK);
 	ASSERT_EQ(moves.size(), 1);
 
 	//check no moves are diagonal to square e4
@@ -362,7 +364,7 @@ TEST(BoardMoveGeneration, EnPassantIsNotFoundWhenNotThere) {
 
 TEST(BoardMoveGeneration, CastlingIsFound) {
 	Board b("8/8/8/8/8/8/8/R3K2R w KQ - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	//check two moves are king castling
 	int castling_moves = 0;
@@ -375,7 +377,7 @@ TEST(BoardMoveGeneration, CastlingIsFound) {
 
 TEST(BoardMoveGeneration, CastlingIsNotFoundWhenNotThere) {
 	Board b("8/8/8/8/8/8/8/R3K2R w - - 0 1");
-	std::vector<Move> moves = b.get_valid_moves(WHITE);
+	MoveList moves = b.get_valid_moves(WHITE);
 
 	//check no moves are king castling
 	int castling_moves = 0;
@@ -384,4 +386,28 @@ TEST(BoardMoveGeneration, CastlingIsNotFoundWhenNotThere) {
 	}
 
 	EXPECT_EQ(castling_moves, 0);
+}
+
+TEST(BoardMoveGeneration, IsLegalAgreesWithGeneratedMoves) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	MoveList moves = b.get_legal_moves(WHITE);
+
+	for (const Move& m : moves) {
+		EXPECT_TRUE(b.is_legal(m));
+	}
+
+	//moves which break the rules for the piece being moved
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(45, 61)))); //queen through its own pawn
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(51, 35)))); //bishop moving like a rook
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(36, 28)))); //pawn pushing into a piece
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(20, 28)))); //the opponent's piece
+}
+
+TEST(BoardMoveGeneration, IsLegalRejectsMovesLeavingKingInCheck) {
+	//the knight on d2 is pinned by the bishop on a5
+	Board b("4k3/8/8/b7/8/8/3N4/4K3 w - - 0 1");
+
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(51, 36))));
+	EXPECT_TRUE(b.is_legal(b.unpack_move(pack_move(60, 61))));
+	EXPECT_FALSE(b.is_legal(b.unpack_move(pack_move(60, 51))));
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/book_builder.h"
+#include "../Dionysus/book_builder.cpp"
+#include "../Dionysus/opening_book.h"
+#include "../Dionysus/utils.h"
+
+#include <cstdio>
+#include <set>
+#include <sstream>
+
+TEST(BookBuilder, SanMovesMatchLegalMoves) {
+	Board b;
+	EXPECT_EQ(create_move_from_san("e4!?", &b), pack_move(52, 36));
+	EXPECT_EQ(create_move_from_san("Nf3", &b), pack_move(62, 45));
+	EXPECT_EQ(create_move_from_san("Nf6", &b), NULL_MOVE);
+	EXPECT_EQ(create_move_from_san("Ke2", &b), NULL_MOVE);
+	EXPECT_EQ(create_move_from_san("x", &b), NULL_MOVE);
+
+	Board c("r3k2r/8/8/8/8/8/8/R3K1NR w KQkq - 0 1");
+	EXPECT_EQ(create_move_from_san("O-O-O", &c), pack_move(60, 58));
+	EXPECT_EQ(create_move_from_san("Rd1", &c), pack_move(56, 59));
+	EXPECT_EQ(create_move_from_san("Ne2", &c), pack_move(62, 52));
+
+	//both knights can reach d2
+	Board d("4k3/8/8/8/8/5N2/8/1N2K3 w - - 0 1");
+	EXPECT_EQ(create_move_from_san("Nbd2", &d), pack_move(57, 51));
+	EXPECT_EQ(create_move_from_san("Nfd2", &d), pack_move(45, 51));
+	EXPECT_EQ(create_move_from_san("N3d2", &d), pack_move(45, 51));
+
+	Board e("1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1");
+	EXPECT_EQ(create_move_from_san("axb8=N", &e), pack_move(8, 1, KNIGHT));
+	EXPECT_EQ(create_move_from_san("a8Q", &e), pack_move(8, 0, QUEEN));
+}
+
+TEST(BookBuilder, CastlingIsStoredAsKingTakesRook) {
+	Board b("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+	Move short_castle = b.unpack_move(pack_move(60, 62));
+	Move long_castle = b.unpack_move(pack_move(60, 58));
+
+	//e1h1 and e1a1
+	EXPECT_EQ(OpeningBook::polyglot_move_code(short_castle), 4 << 6 | 7);
+	EXPECT_EQ(OpeningBook::polyglot_move_code(long_castle), 4 << 6 | 0);
+}
+
+TEST(BookBuilder, BuiltBookOnlyGivesMovesFromWonOrDrawnGames) {
+	std::istringstream pgn(
+		"[Event \"a\"]\n[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 {a comment} Nc6 (2... d6 3. d4) 3. Bb5 1-0\n\n"
+		"[Event \"b\"]\n[Result \"0-1\"]\n\n1.d4 d5 2.c4 $1 e6 0-1\n\n"
+		"[Event \"c\"]\n[Result \"*\"]\n\n1. c4 *\n\n"
+		"[Event \"d\"]\n[Result \"1/2-1/2\"]\n\n1. e4 c5 1/2-1/2\n");
+
+	BookBuilderOptions options;
+	options.threads = 2;
+	options.hash_megabytes = 1;
+	BookBuilder builder(options);
+	builder.add_games(pgn);
+	EXPECT_EQ(builder.get_games_read(), 4);
+	EXPECT_EQ(builder.get_games_skipped(), 1);
+	ASSERT_TRUE(builder.write("book_builder_test.bin"));
+
+	OpeningBook book;
+	ASSERT_TRUE(book.open("book_builder_test.bin"));
+
+	//d4 lost, and c4 was never finished
+	Board b;
+	std::set<PackedMove> seen;
+	for (int i = 0; i < 100; i++) seen.insert(book.probe(&b));
+	EXPECT_EQ(seen, std::set<PackedMove>({ pack_move(52, 36) }));
+
+	//after e4, black lost with e5 but drew with c5
+	b.make_move(b.unpack_move(pack_move(52, 36)));
+	seen.clear();
+	for (int i = 0; i < 100; i++) seen.insert(book.probe(&b));
+	EXPECT_EQ(seen, std::set<PackedMove>({ pack_move(10, 26) }));
+
+	//the variation 2... d6 was never played, so white has no book move after it
+	b.make_move(b.unpack_move(pack_move(12, 28)));
+	b.make_move(b.unpack_move(pack_move(62, 45)));
+	b.make_move(b.unpack_move(pack_move(11, 19)));
+	EXPECT_EQ(book.probe(&b), NULL_MOVE);
+
+	book.close();
+	std::remove("book_builder_test.bin");
+}
+
+//a move which was pruned and then turns up again only counts the games since, so a low count is left out once anything has been pruned
+TEST(BookBuilder, LowCountsArentTrustedAfterPruning) {
+	std::string pgn;
+	for (int i = 0; i < 3; i++) pgn += "[Result \"1-0\"]\n\n1. e4 1-0\n\n";
+
+	//tens of thousands of different one move games, king and pawn positions with the kings kept well apart, overflow a 1 MB table
+	for (int pawn = 40; pawn < 56; pawn++) {
+		for (int white_king = 32; white_king < 64; white_king++) {
+			if (white_king == pawn) continue;
+			for (int black_king = 0; black_king < 24; black_king++) {
+				std::string squares(64, '1');
+				squares[pawn] = 'P';
+				squares[white_king] = 'K';
+				squares[black_king] = 'k';
+
+				std::string fen;
+				for (int rank = 0; rank < 8; rank++) {
+					int empty = 0;
+					for (int file = 0; file < 8; file++) {
+						char c = squares[rank * 8 + file];
+						if (c == '1') {
+							empty++;
+							continue;
+						}
+						if (empty > 0) fen += std::to_string(empty);
+						empty = 0;
+						fen += c;
+					}
+					if (empty > 0) fen += std::to_string(empty);
+					if (rank < 7) fen += '/';
+				}
+				fen += " w - - 0 1";
+
+				Board b(fen);
+				for (const Move& m : b.get_legal_moves(WHITE)) {
+					if (m.start_type != KING) continue;
+					pgn += "[FEN \"" + fen + "\"]\n[Result \"1-0\"]\n\n1. K" + create_lan_from_move(pack_move(m)) + " 1-0\n\n";
+				}
+			}
+		}
+	}
+
+	//only played once, after the table has been pruned
+	pgn += "[Result \"1-0\"]\n\n1. d4 1-0\n";
+
+	BookBuilderOptions options;
+	options.threads = 1;
+	options.hash_megabytes = 1;
+	BookBuilder builder(options);
+	std::istringstream in(pgn);
+	builder.add_games(in);
+	ASSERT_TRUE(builder.write("book_builder_test.bin"));
+
+	OpeningBook book;
+	ASSERT_TRUE(book.open("book_builder_test.bin"));
+
+	Board b;
+	std::set<PackedMove> seen;
+	for (int i = 0; i < 100; i++) seen.insert(book.probe(&b));
+	EXPECT_EQ(seen, std::set<PackedMove>({ pack_move(52, 36) }));
+
+	book.close();
+	std::remove("book_builder_test.bin");
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/move_picker.h"
+#include "../Dionysus/move_picker.cpp"
+
+#include <set>
+
+TEST(MovePicker, EveryLegalMoveIsPickedOnce) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	MoveList legal_moves = b.get_legal_moves(WHITE);
+
+	//a real tt move and killer, plus a killer which is not legal here
+	PackedMove killers[2] = { pack_move(60, 59), pack_move(8, 16) };
+	MovePicker picker(&b, pack_move(legal_moves[5]), killers);
+
+	std::multiset<PackedMove> picked;
+	Move m;
+	while (picker.next(m)) picked.insert(pack_move(m));
+
+	ASSERT_EQ(picked.size(), legal_moves.size());
+	for (const Move& legal : legal_moves) {
+		EXPECT_EQ(picked.count(pack_move(legal)), 1);
+	}
+}
+
+TEST(MovePicker, TTMoveThenCapturesThenKillersThenQuiets) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+	PackedMove tt_move = pack_move(60, 62); //castling
+	PackedMove killers[2] = { pack_move(60, 59), NULL_MOVE };
+	MovePicker picker(&b, tt_move, killers);
+
+	Move m;
+	ASSERT_TRUE(picker.next(m));
+	EXPECT_EQ(pack_move(m), tt_move);
+
+	//winning captures come before the killer
+	ASSERT_TRUE(picker.next(m));
+	EXPECT_NE(m.prev_square, EMPTY_SQUARE);
+	while (m.prev_square != EMPTY_SQUARE && b.see(m) >= 0) ASSERT_TRUE(picker.next(m));
+
+	EXPECT_EQ(pack_move(m), killers[0]);
+}
+
+TEST(MovePicker, IllegalTTMoveIsSkipped) {
+	Board b;
+
+	MovePicker picker(&b, pack_move(52, 28), nullptr);
+
+	int count = 0;
+	Move m;
+	while (picker.next(m)) {
+		EXPECT_NE(pack_move(m), pack_move(52, 28));
+		count++;
+	}
+	EXPECT_EQ(count, 20);
+}
+
+TEST(MovePicker, QuiescencePicksOnlyCaptures) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+	MovePicker picker(&b);
+
+	int count = 0;
+	Move m;
+	while (picker.next(m)) count++;
+	EXPECT_EQ(count, b.get_legal_captures(WHITE).size());
+}
\ No newline at end of file
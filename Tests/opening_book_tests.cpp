@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/opening_book.h"
+#include "../Dionysus/opening_book.cpp"
+
+#include <cstdio>
+#include <set>
+#include <vector>
+
+//writes a polyglot book, with every field big endian, from (key, move, weight) records which are already sorted by key
+void write_test_book(const char* path, const std::vector<std::vector<unsigned long long>>& records) {
+	FILE* file = fopen(path, "wb");
+	for (const auto& record : records) {
+		unsigned long long key = endian_swap_u64(record[0]);
+		unsigned short move = endian_swap_u16((unsigned short)record[1]);
+		unsigned short weight = endian_swap_u16((unsigned short)record[2]);
+		unsigned int learn = 0;
+		fwrite(&key, sizeof(key), 1, file);
+		fwrite(&move, sizeof(move), 1, file);
+		fwrite(&weight, sizeof(weight), 1, file);
+		fwrite(&learn, sizeof(learn), 1, file);
+	}
+	fclose(file);
+}
+
+//polyglot move codes: to file, to row, from file, from row, promotion, 3 bits each, rows counted from white's side
+unsigned short polyglot_move(int from_file, int from_row, int to_file, int to_row) {
+	return (unsigned short)(to_file | to_row << 3 | from_file << 6 | from_row << 9);
+}
+
+TEST(OpeningBook, ProbeFindsEveryWeightedMoveAndNeverAZeroWeightOne) {
+	Board b;
+	unsigned long long key = b.get_zobrist_hash();
+	write_test_book("opening_book_test.bin", {
+		{ 1, polyglot_move(0, 1, 0, 3), 1 },
+		{ key, polyglot_move(4, 1, 4, 3), 5 }, //e2e4
+		{ key, polyglot_move(3, 1, 3, 3), 5 }, //d2d4
+		{ key, polyglot_move(6, 0, 5, 2), 0 }, //g1f3, never played
+		{ key + 1, polyglot_move(2, 1, 2, 3), 1 },
+	});
+
+	OpeningBook book;
+	ASSERT_TRUE(book.open("opening_book_test.bin"));
+
+	//probing many times also checks that a probe doesnt change the book, so the weights stay the same every time
+	std::set<PackedMove> seen;
+	for (int i = 0; i < 200; i++) seen.insert(book.probe(&b));
+	EXPECT_EQ(seen, std::set<PackedMove>({ pack_move(52, 36), pack_move(51, 35) }));
+
+	book.close();
+	std::remove("opening_book_test.bin");
+}
+
+TEST(OpeningBook, PositionNotInBookGivesNoMove) {
+	Board b;
+	write_test_book("opening_book_test.bin", {
+		{ 1, polyglot_move(0, 1, 0, 3), 1 },
+		{ b.get_zobrist_hash() + 1, polyglot_move(4, 1, 4, 3), 1 },
+	});
+
+	OpeningBook book;
+	ASSERT_TRUE(book.open("opening_book_test.bin"));
+	EXPECT_EQ(book.probe(&b), NULL_MOVE);
+
+	book.close();
+	std::remove("opening_book_test.bin");
+
+	EXPECT_FALSE(book.open("missing_book.bin"));
+	EXPECT_EQ(book.probe(&b), NULL_MOVE);
+}
+
+TEST(OpeningBook, IllegalEntriesAreNeverPlayed) {
+	Board b;
+	unsigned long long key = b.get_zobrist_hash();
+	write_test_book("opening_book_test.bin", {
+		{ key, polyglot_move(4, 2, 4, 3), 100 }, //e3e4, nothing on e3
+		{ key, polyglot_move(4, 1, 4, 4), 100 }, //e2e5
+		{ key, polyglot_move(6, 0, 5, 2), 1 }, //g1f3
+	});
+
+	OpeningBook book;
+	ASSERT_TRUE(book.open("opening_book_test.bin"));
+	for (int i = 0; i < 50; i++) EXPECT_EQ(book.probe(&b), pack_move(62, 45));
+	book.close();
+
+	//with nothing legal, the position is treated as out of book
+	write_test_book("opening_book_test.bin", {
+		{ key, polyglot_move(4, 2, 4, 3), 100 },
+	});
+	ASSERT_TRUE(book.open("opening_book_test.bin"));
+	EXPECT_EQ(book.probe(&b), NULL_MOVE);
+
+	book.close();
+	std::remove("opening_book_test.bin");
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/board.h"
+#include "../Dionysus/perft.cpp"
+
+//node counts from https://www.chessprogramming.org/Perft_Results
+
+TEST(Perft, StartingPosition) {
+	Board b;
+	EXPECT_EQ(perft(&b, 1), 20);
+	EXPECT_EQ(perft(&b, 2), 400);
+	EXPECT_EQ(perft(&b, 3), 8902);
+	EXPECT_EQ(perft(&b, 4), 197281);
+	EXPECT_EQ(perft(&b, 5), 4865609);
+}
+
+//lots of castling, pins and en passant
+TEST(Perft, Kiwipete) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	EXPECT_EQ(perft(&b, 1), 48);
+	EXPECT_EQ(perft(&b, 2), 2039);
+	EXPECT_EQ(perft(&b, 3), 97862);
+	EXPECT_EQ(perft(&b, 4), 4085603);
+}
+
+//en passant captures which would expose the king along the rank
+TEST(Perft, Position3) {
+	Board b("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+	EXPECT_EQ(perft(&b, 1), 14);
+	EXPECT_EQ(perft(&b, 2), 191);
+	EXPECT_EQ(perft(&b, 3), 2812);
+	EXPECT_EQ(perft(&b, 4), 43238);
+	EXPECT_EQ(perft(&b, 5), 674624);
+}
+
+//promotions and captures which remove castling rights
+TEST(Perft, Position4) {
+	Board b("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+	EXPECT_EQ(perft(&b, 1), 6);
+	EXPECT_EQ(perft(&b, 2), 264);
+	EXPECT_EQ(perft(&b, 3), 9467);
+	EXPECT_EQ(perft(&b, 4), 422333);
+}
+
+//the same position with the colours swapped, which should give the same counts
+TEST(Perft, Position4Mirrored) {
+	Board b("r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1");
+	EXPECT_EQ(perft(&b, 1), 6);
+	EXPECT_EQ(perft(&b, 2), 264);
+	EXPECT_EQ(perft(&b, 3), 9467);
+	EXPECT_EQ(perft(&b, 4), 422333);
+}
+
+TEST(Perft, Position5) {
+	Board b("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+	EXPECT_EQ(perft(&b, 1), 44);
+	EXPECT_EQ(perft(&b, 2), 1486);
+	EXPECT_EQ(perft(&b, 3), 62379);
+	EXPECT_EQ(perft(&b, 4), 2103487);
+}
+
+TEST(Perft, Position6) {
+	Board b("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+	EXPECT_EQ(perft(&b, 1), 46);
+	EXPECT_EQ(perft(&b, 2), 2079);
+	EXPECT_EQ(perft(&b, 3), 89890);
+	EXPECT_EQ(perft(&b, 4), 3894594);
+}
+
+//making and undoing every move in the tree should leave the board exactly as it started
+TEST(Perft, BoardIsRestoredAfterwards) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	std::vector<int> squares = b.get_squares();
+	unsigned long long hash = b.get_zobrist_hash();
+	int can_castle = b.get_castling_rights();
+
+	perft(&b, 3);
+
+	EXPECT_EQ(squares, b.get_squares());
+	EXPECT_EQ(hash, b.get_zobrist_hash());
+	EXPECT_EQ(can_castle, b.get_castling_rights());
+}
+
+TEST(Perft, ParallelMatchesSerial) {
+	Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	unsigned long long root_counts[MAX_MOVES];
+
+	EXPECT_EQ(perft_parallel(&b, 4, 4, nullptr, root_counts), 4085603);
+
+	//the count below each root move should add up to the same as counting it alone
+	MoveList moves = b.get_legal_moves(WHITE);
+	for (int i = 0; i < moves.size(); i++) {
+		b.make_legal_move(moves[i]);
+		EXPECT_EQ(root_counts[i], perft(&b, 3));
+		b.undo_move(moves[i]);
+	}
+}
+
+TEST(Perft, HashTableDoesNotChangeCounts) {
+	PerftTable table(16);
+
+	Board b("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+	EXPECT_EQ(perft(&b, 4, &table), 422333);
+	EXPECT_EQ(perft_parallel(&b, 4, 4, &table), 422333);
+
+	Board start;
+	EXPECT_EQ(perft_parallel(&start, 5, 3, &table), 4865609);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/searcher.h"
+#include "../Dionysus/utils.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+//a BookFile can be any file at all, so a book move which isnt legal has to be ignored and the position searched instead
+TEST(Searcher, IllegalBookMoveIsSearchedInstead) {
+	Board b;
+
+	//one big endian polyglot entry for the starting position, e3e4 with nothing on e3
+	unsigned long long key = endian_swap_u64(b.get_zobrist_hash());
+	unsigned short move = endian_swap_u16((unsigned short)(4 | 3 << 3 | 4 << 6 | 2 << 9));
+	unsigned short weight = endian_swap_u16(1);
+	unsigned int learn = 0;
+	FILE* file = fopen("searcher_test.bin", "wb");
+	fwrite(&key, sizeof(key), 1, file);
+	fwrite(&move, sizeof(move), 1, file);
+	fwrite(&weight, sizeof(weight), 1, file);
+	fwrite(&learn, sizeof(learn), 1, file);
+	fclose(file);
+
+	Searcher searcher;
+	searcher.set_book_file("searcher_test.bin");
+
+	SearchLimits limits;
+	limits.depth = 2;
+	PackedMove best = NULL_MOVE;
+	searcher.start_search(limits, b, [&best](PackedMove m, PackedMove) { best = m; });
+	searcher.wait();
+
+	ASSERT_NE(best, NULL_MOVE);
+	EXPECT_TRUE(b.is_legal(b.unpack_move(best)));
+	EXPECT_NE(best, pack_move(44, 36));
+
+	std::remove("searcher_test.bin");
+}
+
+//the odd helper threads run ahead of the main thread and store the root first, but every iteration reported should still have been searched
+TEST(Searcher, HelperThreadsDontCutIterationsShort) {
+	Board b;
+	Searcher searcher(false);
+	searcher.set_threads(4);
+
+	SearchLimits limits;
+	limits.depth = 6;
+	testing::internal::CaptureStdout();
+	searcher.start_search(limits, b, [](PackedMove, PackedMove) {});
+	searcher.wait();
+	std::string output = testing::internal::GetCapturedStdout();
+
+	//info depth <depth> seldepth <ply> ... pv <moves>
+	std::istringstream lines(output);
+	std::string line;
+	int checked = 0;
+	while (std::getline(lines, line)) {
+		std::istringstream words(line);
+		std::string info, depth_word, seldepth_word;
+		int depth = 0, seldepth = 0;
+		words >> info >> depth_word >> depth >> seldepth_word >> seldepth;
+		if (seldepth_word != "seldepth" || depth < 4) continue;
+
+		size_t pv_start = line.find(" pv ");
+		ASSERT_NE(pv_start, std::string::npos);
+		std::istringstream pv(line.substr(pv_start + 4));
+		std::string move;
+		int pv_length = 0;
+		while (pv >> move) pv_length++;
+
+		EXPECT_GT(seldepth, 1) << line;
+		EXPECT_GT(pv_length, 1) << line;
+		checked++;
+	}
+	EXPECT_EQ(checked, 3);
+}
+
+//a stop can come before the first iteration has finished, but the gui still has to be sent a legal move
+TEST(Searcher, StopBeforeAnyIterationStillGivesALegalMove) {
+	Board b;
+	Searcher searcher(false);
+
+	SearchLimits limits;
+	limits.infinite = true;
+	for (int i = 0; i < 20; i++) {
+		PackedMove best = NULL_MOVE;
+		testing::internal::CaptureStdout();
+		searcher.start_search(limits, b, [&best](PackedMove m, PackedMove) { best = m; });
+		searcher.stop();
+		searcher.wait();
+		testing::internal::GetCapturedStdout();
+
+		ASSERT_NE(best, NULL_MOVE);
+		EXPECT_TRUE(b.is_legal(b.unpack_move(best)));
+
+		//with nothing in the table the first legal move is used, after that the table's move
+		searcher.clear_hash();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/defs.h"
+#include "../Dionysus/time_manager.h"
+#include "../Dionysus/time_manager.cpp"
+
+TEST(TimeManager, MoveTimeIsUsedLessOverhead) {
+	SearchLimits limits;
+	limits.move_time = 1000;
+
+	TimeManager tm;
+	tm.init(limits, WHITE, 50);
+	EXPECT_TRUE(tm.has_deadline());
+	EXPECT_EQ(tm.get_soft_limit(), 950);
+	EXPECT_EQ(tm.get_hard_limit(), 950);
+}
+
+TEST(TimeManager, ClockIsSharedBetweenRemainingMoves) {
+	SearchLimits limits;
+	limits.time[WHITE] = 60000;
+	limits.time[BLACK] = 1000;
+	limits.increment[WHITE] = 1000;
+	limits.moves_to_go = 20;
+
+	TimeManager tm;
+	tm.init(limits, WHITE, 0);
+	EXPECT_EQ(tm.get_soft_limit(), 60000 / 20 + 750);
+	EXPECT_EQ(tm.get_hard_limit(), (60000 / 20 + 750) * 3);
+
+	//black's clock is the one which matters when black is to move
+	tm.init(limits, BLACK, 0);
+	EXPECT_EQ(tm.get_soft_limit(), 1000 / 20);
+}
+
+TEST(TimeManager, NeverPlansToUseMostOfTheClock) {
+	SearchLimits limits;
+	limits.time[WHITE] = 2000;
+	limits.increment[WHITE] = 5000;
+
+	TimeManager tm;
+	tm.init(limits, WHITE, 100);
+	EXPECT_LE(tm.get_hard_limit(), (2000 - 100) * 4 / 5);
+	EXPECT_LE(tm.get_soft_limit(), tm.get_hard_limit());
+}
+
+TEST(TimeManager, DepthAndInfiniteSearchesHaveNoDeadline) {
+	SearchLimits limits;
+	limits.depth = 6;
+
+	TimeManager tm;
+	tm.init(limits, WHITE, 10);
+	EXPECT_FALSE(tm.has_deadline());
+	EXPECT_FALSE(tm.past_soft_limit());
+}
+
+TEST(TimeManager, InfiniteIgnoresTheClocks) {
+	SearchLimits limits;
+	limits.infinite = true;
+	limits.time[WHITE] = 60000;
+	limits.time[BLACK] = 60000;
+	limits.move_time = 1000;
+
+	TimeManager tm;
+	tm.init(limits, WHITE, 10);
+	EXPECT_FALSE(tm.has_deadline());
+	EXPECT_FALSE(tm.past_hard_limit());
+}
+
+TEST(TimeManager, OnlyTheOpponentsClockStillGivesADeadline) {
+	SearchLimits limits;
+	limits.time[WHITE] = 60000;
+
+	TimeManager tm;
+	tm.init(limits, BLACK, 10);
+	EXPECT_TRUE(tm.has_deadline());
+	EXPECT_EQ(tm.get_hard_limit(), DEFAULT_MOVE_TIME - 10);
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "gtest/gtest.h"
+#include "../Dionysus/transposition_table.h"
+#include "../Dionysus/transposition_table.cpp"
+
+#include <atomic>
+#include <climits>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST(TranspositionTable, StoredEntryIsFound) {
+	TranspositionTable tt(1);
+	tt.store(0x123456789ULL, { LOWER_BOUND, 5, pack_move(52, 36), 42, 0, 0 });
+
+	TransTableEntry entry = tt.get_if_exists(0x123456789ULL);
+	EXPECT_EQ(entry.flag, LOWER_BOUND);
+	EXPECT_EQ(entry.depth, 5);
+	EXPECT_EQ(entry.move, pack_move(52, 36));
+	EXPECT_EQ(entry.score, 42);
+
+	//same bucket, different position
+	EXPECT_EQ(tt.get_if_exists(0x123456789ULL ^ 1).flag, NOT_PRESENT);
+}
+
+TEST(TranspositionTable, FullBucketReplacesShallowestEntry) {
+	TranspositionTable tt(1);
+
+	//five positions which all land in the same bucket, the shallowest of the first four should make way for the fifth
+	int depths[5] = { 7, 3, 9, 5, 4 };
+	for (int i = 0; i < 5; i++) {
+		tt.store(((unsigned long long)i << 40) | 17, { EXACT, (unsigned char)depths[i], NULL_MOVE, 0, 0, 0 });
+	}
+
+	EXPECT_EQ(tt.get_if_exists((0ULL << 40) | 17).flag, EXACT);
+	EXPECT_EQ(tt.get_if_exists((1ULL << 40) | 17).flag, NOT_PRESENT);
+	EXPECT_EQ(tt.get_if_exists((2ULL << 40) | 17).flag, EXACT);
+	EXPECT_EQ(tt.get_if_exists((3ULL << 40) | 17).flag, EXACT);
+	EXPECT_EQ(tt.get_if_exists((4ULL << 40) | 17).flag, EXACT);
+}
+
+TEST(TranspositionTable, ClearRemovesEverything) {
+	TranspositionTable tt(1);
+	tt.store(99, { EXACT, 1, NULL_MOVE, 0, 0, 0 });
+	tt.clear();
+
+	EXPECT_EQ(tt.get_if_exists(99).flag, NOT_PRESENT);
+}
+
+TEST(TranspositionTable, ResizedTableStartsEmptyAndStillWorks) {
+	TranspositionTable tt(1);
+	tt.store(99, { EXACT, 1, NULL_MOVE, 0, 0, 0 });
+	tt.resize(32);
+
+	EXPECT_EQ(tt.get_if_exists(99).flag, NOT_PRESENT);
+
+	tt.store(99, { UPPER_BOUND, 2, NULL_MOVE, -7, 0, 0 });
+	EXPECT_EQ(tt.get_if_exists(99).flag, UPPER_BOUND);
+	EXPECT_EQ(tt.get_if_exists(99).score, -7);
+}
+
+TEST(TranspositionTable, SizeWhichIsntAPowerOfTwoIsUsedInFull) {
+	//3 MB is not a whole number of huge pages either
+	TranspositionTable tt(3);
+
+	//the largest hashes land in the very last bucket
+	tt.store(~0ULL, { LOWER_BOUND, 3, NULL_MOVE, 11, 0, 0 });
+	EXPECT_EQ(tt.get_if_exists(~0ULL).flag, LOWER_BOUND);
+	EXPECT_EQ(tt.get_if_exists(~0ULL).score, 11);
+}
+
+TEST(TranspositionTable, FailedResizeKeepsTheOldTable) {
+	TranspositionTable tt(1);
+	tt.store(99, { EXACT, 1, NULL_MOVE, 0, 0, 0 });
+
+	//far more than any machine has
+	EXPECT_THROW(tt.resize(INT_MAX), std::bad_alloc);
+	EXPECT_EQ(tt.get_if_exists(99).flag, EXACT);
+}
+
+TEST(TranspositionTable, EntriesFromOldSearchesAreReplacedFirst) {
+	TranspositionTable tt(1);
+
+	//a deep entry from an old search, then three shallow ones from the current search fill the bucket
+	tt.store(17, { EXACT, 12, NULL_MOVE, 0, 0, 0 });
+	tt.new_search();
+	tt.new_search();
+	for (int i = 1; i < 4; i++) {
+		tt.store(((unsigned long long)i << 40) | 17, { EXACT, 2, NULL_MOVE, 0, 0, 0 });
+	}
+
+	tt.store((4ULL << 40) | 17, { EXACT, 1, NULL_MOVE, 0, 0, 0 });
+
+	EXPECT_EQ(tt.get_if_exists(17).flag, NOT_PRESENT);
+	for (int i = 1; i < 5; i++) {
+		EXPECT_EQ(tt.get_if_exists(((unsigned long long)i << 40) | 17).flag, EXACT);
+	}
+}
+
+TEST(TranspositionTable, HashfullOnlyCountsTheCurrentSearch) {
+	TranspositionTable tt(1);
+	EXPECT_EQ(tt.hashfull(), 0);
+
+	//one entry in each sampled bucket is a quarter of the sample
+	for (unsigned long long i = 0; i < HASHFULL_SAMPLE_BUCKETS; i++) {
+		tt.store(i << 50, { EXACT, 1, NULL_MOVE, 0, 0, 0 });
+	}
+	EXPECT_EQ(tt.hashfull(), 250);
+
+	tt.new_search();
+	EXPECT_EQ(tt.hashfull(), 0);
+}
+
+TEST(TranspositionTable, ConcurrentAccessNeverReturnsTornEntries) {
+	TranspositionTable tt(1);
+
+	//every key always stores the same entry, worked out from the key, so any hit which doesnt match it was torn
+	auto entry_for = [](unsigned long long key) -> TransTableEntry {
+		unsigned long long mixed = key * 0x9E3779B97F4A7C15ULL;
+		return { (signed char)(1 + mixed % 3), (unsigned char)(mixed >> 8), (PackedMove)(mixed >> 16), (short)(mixed >> 32), 0, 0 };
+	};
+
+	std::atomic<long long> hits(0), torn(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; t++) {
+		threads.emplace_back([&, t] {
+			std::mt19937_64 rng(t);
+			for (int i = 0; i < 100000; i++) {
+				//a few hundred keys crowded into four buckets, so the threads are constantly writing over each other
+				unsigned long long key = (rng() % 4) << 62 | (rng() % 256);
+				if (rng() % 2) {
+					tt.store(key, entry_for(key));
+					continue;
+				}
+
+				TransTableEntry found = tt.get_if_exists(key);
+				if (found.flag == NOT_PRESENT) continue;
+
+				TransTableEntry expected = entry_for(key);
+				hits++;
+				if (found.flag != expected.flag || found.depth != expected.depth || found.move != expected.move || found.score != expected.score) torn++;
+			}
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+
+	EXPECT_GT(hits, 0);
+	EXPECT_EQ(torn, 0);
+}
\ No newline at end of file